@@ -0,0 +1,236 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "archive.h"
+#include "png.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string_view>
+
+namespace {
+
+constexpr uint32_t tarBlock = 512;
+constexpr uint64_t zip32Limit = 0xFFFFFFFF;
+
+void put16(std::vector<uint8_t>& out, uint32_t value) {
+  out.push_back(static_cast<uint8_t>(value));
+  out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void put32(std::vector<uint8_t>& out, uint32_t value) {
+  put16(out, value & 0xFFFF);
+  put16(out, value >> 16);
+}
+
+void put64(std::vector<uint8_t>& out, uint64_t value) {
+  put32(out, static_cast<uint32_t>(value));
+  put32(out, static_cast<uint32_t>(value >> 32));
+}
+
+} // namespace
+
+bool archiveFormatFromPath(const char* path, ArchiveFormat& format) {
+  const std::string_view name = path;
+  if (name.ends_with(".tar"))
+    format = ArchiveFormat::Tar;
+  else if (name.ends_with(".zip"))
+    format = ArchiveFormat::Zip;
+  else
+    return false;
+  return true;
+}
+
+ArchiveWriter::ArchiveWriter(std::ostream& out, ArchiveFormat format) : out(out), format(format) {
+  const std::time_t now = std::time(nullptr);
+  mtime = static_cast<uint32_t>(now);
+  const std::tm local = *std::localtime(&now);
+  dosTime = static_cast<uint16_t>(local.tm_hour << 11 | local.tm_min << 5 | local.tm_sec / 2);
+  dosDate = static_cast<uint16_t>(std::max(local.tm_year - 80, 0) << 9 | (local.tm_mon + 1) << 5 | local.tm_mday);
+  writer = std::thread(&ArchiveWriter::writerLoop, this);
+}
+
+ArchiveWriter::~ArchiveWriter() {
+  finish();
+}
+
+bool ArchiveWriter::add(std::string name, std::string data) {
+  // ustar keeps names in a 100 byte field, zip sizes stay 32 bit (zip64 is only used for offsets)
+  if ((format == ArchiveFormat::Tar && name.size() > 100) || data.size() >= zip32Limit || name.size() > 0xFFFF)
+    return false;
+  std::unique_lock lock(mutex);
+  cv.wait(lock, [this] { return queue.size() < queueLimit; });
+  queue.push_back({std::move(name), std::move(data)});
+  cv.notify_all();
+  return !failed;
+}
+
+void ArchiveWriter::writerLoop() {
+  std::unique_lock lock(mutex);
+  while (true) {
+    cv.wait(lock, [this] { return stopping || !queue.empty(); });
+    if (queue.empty())
+      return;
+    // Stays queued while it's written so the queue still counts it against the limit
+    const Member& member = queue.front();
+    lock.unlock();
+    if (!failed)
+      writeMember(member);
+    lock.lock();
+    queue.pop_front();
+    cv.notify_all();
+  }
+}
+
+void ArchiveWriter::put(const void* data, size_t size) {
+  out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+  offset += size;
+  if (!out)
+    failed = true;
+}
+
+void ArchiveWriter::writeMember(const Member& member) {
+  Entry entry = {member.name, offset, 0, member.data.size(), 0};
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(member.data.data());
+  if (format == ArchiveFormat::Tar) {
+    writeTarHeader(member.name, entry.size);
+    entry.dataOffset = offset;
+    put(data, entry.size);
+    static const uint8_t zeros[tarBlock] = {};
+    put(zeros, (tarBlock - entry.size % tarBlock) % tarBlock);
+  } else {
+    entry.crc = updateCrc32(0, data, entry.size);
+    std::vector<uint8_t> header;
+    put32(header, 0x04034B50);
+    put16(header, 20);     // Version needed, 2.0
+    put16(header, 0x0800); // UTF-8 names
+    put16(header, 0);      // Stored
+    put16(header, dosTime);
+    put16(header, dosDate);
+    put32(header, entry.crc);
+    put32(header, static_cast<uint32_t>(entry.size));
+    put32(header, static_cast<uint32_t>(entry.size));
+    put16(header, static_cast<uint32_t>(member.name.size()));
+    put16(header, 0);
+    header.insert(header.end(), member.name.begin(), member.name.end());
+    put(header.data(), header.size());
+    entry.dataOffset = offset;
+    put(data, entry.size);
+  }
+  entries.push_back(std::move(entry));
+}
+
+void ArchiveWriter::writeTarHeader(const std::string& name, uint64_t size) {
+  char header[tarBlock] = {};
+  std::memcpy(header, name.data(), name.size());
+  std::snprintf(header + 100, 8, "%07o", 0644);
+  std::snprintf(header + 108, 8, "%07o", 0);
+  std::snprintf(header + 116, 8, "%07o", 0);
+  std::snprintf(header + 124, 12, "%011llo", static_cast<unsigned long long>(size));
+  std::snprintf(header + 136, 12, "%011lo", static_cast<unsigned long>(mtime));
+  header[156] = '0'; // Regular file
+  std::memcpy(header + 257, "ustar", 6);
+  std::memcpy(header + 263, "00", 2);
+  // Checksum is over the header with its own field as spaces
+  std::memset(header + 148, ' ', 8);
+  uint32_t checksum = 0;
+  for (const char c : header)
+    checksum += static_cast<uint8_t>(c);
+  std::snprintf(header + 148, 8, "%06o", checksum);
+  header[155] = ' ';
+  put(header, sizeof(header));
+}
+
+void ArchiveWriter::writeTarIndex() {
+  std::string index;
+  for (const Entry& entry : entries)
+    index += entry.name + " " + std::to_string(entry.dataOffset) + " " + std::to_string(entry.size) + "\n";
+  writeTarHeader("index.txt", index.size());
+  put(index.data(), index.size());
+  // Pad the member, then the two empty blocks that end the archive
+  static const uint8_t zeros[tarBlock * 3] = {};
+  put(zeros, (tarBlock - index.size() % tarBlock) % tarBlock + tarBlock * 2);
+}
+
+void ArchiveWriter::writeZipDirectory() {
+  const uint64_t directoryOffset = offset;
+  std::vector<uint8_t> record;
+  for (const Entry& entry : entries) {
+    const bool zip64 = entry.headerOffset >= zip32Limit;
+    record.clear();
+    put32(record, 0x02014B50);
+    put16(record, 45);              // Made by 4.5
+    put16(record, zip64 ? 45 : 20); // Version needed
+    put16(record, 0x0800);
+    put16(record, 0);
+    put16(record, dosTime);
+    put16(record, dosDate);
+    put32(record, entry.crc);
+    put32(record, static_cast<uint32_t>(entry.size));
+    put32(record, static_cast<uint32_t>(entry.size));
+    put16(record, static_cast<uint32_t>(entry.name.size()));
+    put16(record, zip64 ? 12 : 0); // Extra field
+    put16(record, 0);              // Comment
+    put16(record, 0);              // Disk
+    put16(record, 0);              // Internal attributes
+    put32(record, 0);              // External attributes
+    put32(record, static_cast<uint32_t>(std::min(entry.headerOffset, zip32Limit)));
+    record.insert(record.end(), entry.name.begin(), entry.name.end());
+    if (zip64) {
+      put16(record, 0x0001); // Zip64 extended information, just the offset
+      put16(record, 8);
+      put64(record, entry.headerOffset);
+    }
+    put(record.data(), record.size());
+  }
+  const uint64_t directorySize = offset - directoryOffset;
+  const uint64_t count = entries.size();
+
+  record.clear();
+  if (count >= 0xFFFF || directoryOffset >= zip32Limit || directorySize >= zip32Limit) {
+    const uint64_t endOffset = offset;
+    put32(record, 0x06064B50); // Zip64 end of central directory
+    put64(record, 44);
+    put16(record, 45);
+    put16(record, 45);
+    put32(record, 0);
+    put32(record, 0);
+    put64(record, count);
+    put64(record, count);
+    put64(record, directorySize);
+    put64(record, directoryOffset);
+    put32(record, 0x07064B50); // Locator
+    put32(record, 0);
+    put64(record, endOffset);
+    put32(record, 1);
+  }
+  put32(record, 0x06054B50); // End of central directory, saturated fields point readers at the zip64 one
+  put16(record, 0);
+  put16(record, 0);
+  put16(record, static_cast<uint32_t>(std::min<uint64_t>(count, 0xFFFF)));
+  put16(record, static_cast<uint32_t>(std::min<uint64_t>(count, 0xFFFF)));
+  put32(record, static_cast<uint32_t>(std::min(directorySize, zip32Limit)));
+  put32(record, static_cast<uint32_t>(std::min(directoryOffset, zip32Limit)));
+  put16(record, 0);
+  put(record.data(), record.size());
+}
+
+bool ArchiveWriter::finish() {
+  if (finished)
+    return !failed;
+  {
+    const std::lock_guard lock(mutex);
+    stopping = true;
+  }
+  cv.notify_all();
+  writer.join();
+  finished = true;
+  if (!failed) {
+    if (format == ArchiveFormat::Tar)
+      writeTarIndex();
+    else
+      writeZipDirectory();
+  }
+  return !failed;
+}
@@ -0,0 +1,78 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class ArchiveFormat : uint8_t {
+  Tar, // ustar, ends with an index.txt member
+  Zip, // Stored (no compression), zip64 once past 4GB or 65535 members
+};
+
+// .tar or .zip, false for anything else
+bool archiveFormatFromPath(const char* path, ArchiveFormat& format);
+
+// Appends files to one archive streamed out sequentially, nothing is ever seeked back to so out
+// can be a DirectFile or a pipe. Members are handed over encoded in memory and written by a writer
+// thread, at most queueLimit of them wait at a time.
+//
+// The index lists every member with the offset of its data in the archive:
+// zip has it as the central directory, tar gets an index.txt member at the end with
+// "<name> <offset> <size>" lines.
+class ArchiveWriter {
+public:
+  ArchiveWriter(std::ostream& out, ArchiveFormat format);
+  ~ArchiveWriter();
+
+  // Blocks while the queue is full, false if the name doesn't fit or a write already failed
+  bool add(std::string name, std::string data);
+  // Writes the rest, the index and the end records. out still needs flushing/closing by the owner.
+  bool finish();
+
+private:
+  struct Member {
+    std::string name;
+    std::string data;
+  };
+
+  struct Entry {
+    std::string name;
+    uint64_t headerOffset;
+    uint64_t dataOffset;
+    uint64_t size;
+    uint32_t crc;
+  };
+
+  static constexpr size_t queueLimit = 4;
+
+  void writerLoop();
+  void writeMember(const Member& member);
+  void writeTarHeader(const std::string& name, uint64_t size);
+  void writeTarIndex();
+  void writeZipDirectory();
+  void put(const void* data, size_t size);
+
+  std::ostream& out;
+  ArchiveFormat format;
+  uint64_t offset = 0;
+  uint32_t mtime;
+  uint16_t dosTime;
+  uint16_t dosDate;
+  std::vector<Entry> entries;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<Member> queue;
+  bool stopping = false;
+  bool finished = false;
+  std::atomic<bool> failed = false;
+  std::thread writer;
+};
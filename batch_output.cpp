@@ -0,0 +1,105 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "batch_output.h"
+
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+BatchOutput::BatchOutput(ImageFormat format, uint32_t width, uint32_t height, const GammaLut* gamma)
+    : format(format), width(width), height(height), gamma(gamma) {}
+
+BatchOutput::~BatchOutput() {
+  // The archive writes into one of the files, it has to go first
+  archive.reset();
+}
+
+bool BatchOutput::open(const char* outputPath, bool direct) {
+  path = outputPath;
+  directIO = direct;
+  ArchiveFormat archiveFormat;
+  if (archiveFormatFromPath(outputPath, archiveFormat)) {
+    if (directIO) {
+      if (!directArchiveFile.open(outputPath))
+        return false;
+      archive = std::make_unique<ArchiveWriter>(directArchiveFile, archiveFormat);
+    } else {
+      archiveFile.open(outputPath, std::ios::out | std::ios::binary);
+      if (!archiveFile) {
+        std::cout << "Failed to open " << outputPath << " for writing!" << std::endl;
+        return false;
+      }
+      archive = std::make_unique<ArchiveWriter>(archiveFile, archiveFormat);
+    }
+    return true;
+  }
+  std::error_code error;
+  std::filesystem::create_directories(outputPath, error);
+  if (error) {
+    std::cout << "Failed to create " << outputPath << ": " << error.message() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool BatchOutput::nameImages(const std::vector<const char*>& dumps) {
+  std::vector<std::string> stems;
+  std::unordered_map<std::string, size_t> uses;
+  for (const char* dump : dumps)
+    uses[stems.emplace_back(std::filesystem::path(dump).stem().string())]++;
+  names.clear();
+  std::unordered_set<std::string> taken;
+  for (size_t i = 0; i < dumps.size(); i++) {
+    std::string name = stems[i];
+    if (uses[name] > 1)
+      name += "-" + std::to_string(i + 1);
+    name += imageExtension(format);
+    // Only left when a dump is already called like the suffixed name of another (fb-2.bin next to two fb.bin)
+    if (!taken.insert(name).second) {
+      std::cout << "More than one dump would be written to " << name << std::endl;
+      return false;
+    }
+    names.push_back(std::move(name));
+  }
+  return true;
+}
+
+bool BatchOutput::write(const std::string& name, const std::function<bool(ImageWriter&)>& convert) {
+  if (archive) {
+    // Encoded in memory, the archive's writer thread appends it while the next one converts
+    std::ostringstream encoded;
+    ImageWriter writer(encoded, format, width, height, gamma);
+    return convert(writer) && archive->add(name, std::move(encoded).str());
+  }
+  const std::filesystem::path file = std::filesystem::path(path) / name;
+  if (directIO) {
+    DirectFile out;
+    bool ok = out.open(file.string().c_str());
+    if (ok) {
+      ImageWriter writer(out, format, width, height, gamma);
+      ok = convert(writer);
+    }
+    return out.close() && ok;
+  }
+  std::ofstream out(file, std::ios::out | std::ios::binary);
+  ImageWriter writer(out, format, width, height, gamma);
+  return writer && convert(writer);
+}
+
+bool BatchOutput::close() {
+  if (!archive)
+    return true;
+  bool ok = archive->finish();
+  archive.reset();
+  if (directIO) {
+    ok = directArchiveFile.close() && ok;
+  } else {
+    archiveFile.close();
+    ok = archiveFile.good() && ok;
+  }
+  if (!ok)
+    std::cout << "Failed to write " << path << "!" << std::endl;
+  return ok;
+}
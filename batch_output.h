@@ -0,0 +1,47 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "archive.h"
+#include "direct_file.h"
+#include "image.h"
+
+// Where --batch puts its images: one file per dump in a directory, or members of a .tar/.zip archive.
+// With directIO every file (or the archive) is written through DirectFile.
+class BatchOutput {
+public:
+  BatchOutput(ImageFormat format, uint32_t width, uint32_t height, const GammaLut* gamma);
+  ~BatchOutput();
+
+  bool open(const char* path, bool directIO);
+  // Names the images of dumps, their file names with the format's extension. Dumps sharing a file name
+  // (a/fb.bin and b/fb.bin) get their position on the command line appended, fb-1.pam and fb-2.pam, rather
+  // than overwriting each other. False if the names still collide.
+  bool nameImages(const std::vector<const char*>& dumps);
+  const std::string& imageName(size_t dump) const {
+    return names[dump];
+  }
+  // convert writes the whole image (through finish()) into the writer it's given
+  bool write(const std::string& name, const std::function<bool(ImageWriter&)>& convert);
+  // Flushes the archive, if any
+  bool close();
+
+private:
+  ImageFormat format;
+  uint32_t width;
+  uint32_t height;
+  const GammaLut* gamma;
+  std::string path;
+  std::vector<std::string> names;
+  bool directIO = false;
+  std::ofstream archiveFile;
+  DirectFile directArchiveFile;
+  std::unique_ptr<ArchiveWriter> archive;
+};
@@ -0,0 +1,35 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "bc.h"
+#include "bc_block.h"
+#include "simd.h"
+
+static void detileDecodeScalar(const uint8_t* src, uint32_t* dst, uint32_t width, uint32_t height,
+                               SurfaceFormat format, bool swap) {
+  const uint32_t blockSize = bytesPerBlock(format);
+  const uint32_t logBpb = blockSize == 8 ? 3 : 4;
+  const uint32_t blocksX = (width + 3) / 4;
+  const uint32_t blocksY = (height + 3) / 4;
+
+  uint8_t block[16];
+  BlockPalette pal{};
+  for (uint32_t by = 0; by < blocksY; by++) {
+    for (uint32_t bx = 0; bx < blocksX; bx++) {
+      // Straight from the tiled block to the linear texels, no block-linear staging
+      const uint32_t offset = xeTiledOffset2D(bx, by, blocksX, logBpb);
+      loadBlock(src + static_cast<uint64_t>(offset) * blockSize, blockSize, swap, block);
+      buildPalette(block, format, pal);
+      decodeBlock(pal, format, dst + static_cast<uint64_t>(by) * 4 * width + bx * 4, width,
+                  std::min(4u, width - bx * 4), std::min(4u, height - by * 4));
+    }
+  }
+}
+
+void detileDecodeBC(const uint8_t* src, uint32_t* dst, uint32_t width, uint32_t height, SurfaceFormat format,
+                    bool swap) {
+  static const SimdKernels* kernels = simdKernels(bestCpuBackend());
+  if (kernels)
+    kernels->detileDecodeBC(src, dst, width, height, format, swap);
+  else
+    detileDecodeScalar(src, dst, width, height, format, swap);
+}
@@ -0,0 +1,13 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+
+#include "xenos.h"
+
+// Detiles and decodes a tiled BC1/BC2/BC3/BC5 texture in one pass, no block-linear copy in between.
+// dst is width * height ARGB pixels (same packing as the framebuffer).
+// swap undoes the 8in16 endian swap the console stores textures with.
+void detileDecodeBC(const uint8_t* src, uint32_t* dst, uint32_t width, uint32_t height, SurfaceFormat format,
+                    bool swap = true);
@@ -0,0 +1,143 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "xenos.h"
+
+// BC block parsing shared by the scalar decoder (bc.cpp) and the SIMD kernels (simd.cpp)
+
+// Block data, already endian swapped and split into palettes + indices
+struct BlockPalette {
+  uint32_t color[4]; // ARGB, alpha forced to 0xFF (except BC1 punch-through)
+  uint8_t alpha[8];  // BC3 alpha / BC5 red
+  uint8_t green[8];  // BC5 green
+  uint32_t colorBits;
+  uint64_t alphaBits; // BC2 4bpp alpha, or BC3/BC5 3bpp indices for alpha/red
+  uint64_t greenBits;
+};
+
+inline void loadBlock(const uint8_t* src, uint32_t size, bool swap, uint8_t* out) {
+  std::memcpy(out, src, size);
+  if (swap) {
+    for (uint32_t i = 0; i < size; i += 2)
+      std::swap(out[i], out[i + 1]);
+  }
+}
+
+inline uint32_t expand565(uint32_t c) {
+  const uint32_t r = (c >> 11) & 31;
+  const uint32_t g = (c >> 5) & 63;
+  const uint32_t b = c & 31;
+  return 0xFF000000 | ((r << 3 | r >> 2) << 16) | ((g << 2 | g >> 4) << 8) | (b << 3 | b >> 2);
+}
+
+// Per channel (wa * a + wb * b) / div, alpha stays 0xFF
+inline uint32_t lerpColor(uint32_t a, uint32_t b, uint32_t wa, uint32_t wb, uint32_t div) {
+  uint32_t out = 0xFF000000;
+  for (int shift = 0; shift < 24; shift += 8) {
+    const uint32_t ca = (a >> shift) & 0xFF;
+    const uint32_t cb = (b >> shift) & 0xFF;
+    out |= ((ca * wa + cb * wb) / div) << shift;
+  }
+  return out;
+}
+
+inline void colorPalette(const uint8_t* block, bool bc1, BlockPalette& pal) {
+  const uint32_t c0 = block[0] | block[1] << 8;
+  const uint32_t c1 = block[2] | block[3] << 8;
+  pal.color[0] = expand565(c0);
+  pal.color[1] = expand565(c1);
+  if (!bc1 || c0 > c1) {
+    pal.color[2] = lerpColor(pal.color[0], pal.color[1], 2, 1, 3);
+    pal.color[3] = lerpColor(pal.color[0], pal.color[1], 1, 2, 3);
+  } else {
+    pal.color[2] = lerpColor(pal.color[0], pal.color[1], 1, 1, 2);
+    pal.color[3] = 0; // Transparent black
+  }
+  std::memcpy(&pal.colorBits, block + 4, 4);
+}
+
+// BC3 alpha / BC4 channel, 2 endpoints + 48 bits of 3 bit indices
+inline void channelPalette(const uint8_t* block, uint8_t* pal, uint64_t& bits) {
+  const uint32_t a0 = block[0];
+  const uint32_t a1 = block[1];
+  pal[0] = a0;
+  pal[1] = a1;
+  if (a0 > a1) {
+    for (uint32_t i = 1; i < 7; i++)
+      pal[i + 1] = static_cast<uint8_t>(((7 - i) * a0 + i * a1) / 7);
+  } else {
+    for (uint32_t i = 1; i < 5; i++)
+      pal[i + 1] = static_cast<uint8_t>(((5 - i) * a0 + i * a1) / 5);
+    pal[6] = 0;
+    pal[7] = 255;
+  }
+  bits = 0;
+  std::memcpy(&bits, block + 2, 6);
+}
+
+inline void buildPalette(const uint8_t* block, SurfaceFormat format, BlockPalette& pal) {
+  switch (format) {
+  case SurfaceFormat::k_DXT1:
+    colorPalette(block, true, pal);
+    break;
+  case SurfaceFormat::k_DXT2_3:
+    std::memcpy(&pal.alphaBits, block, 8);
+    colorPalette(block + 8, false, pal);
+    break;
+  case SurfaceFormat::k_DXT4_5:
+    channelPalette(block, pal.alpha, pal.alphaBits);
+    colorPalette(block + 8, false, pal);
+    break;
+  case SurfaceFormat::k_DXN:
+    channelPalette(block, pal.alpha, pal.alphaBits);
+    channelPalette(block + 8, pal.green, pal.greenBits);
+    break;
+  default:
+    break;
+  }
+}
+
+inline uint32_t decodeTexel(const BlockPalette& pal, SurfaceFormat format, uint32_t i) {
+  switch (format) {
+  case SurfaceFormat::k_DXT1:
+    return pal.color[(pal.colorBits >> (i * 2)) & 3];
+  case SurfaceFormat::k_DXT2_3:
+    return (pal.color[(pal.colorBits >> (i * 2)) & 3] & 0x00FFFFFF) |
+           static_cast<uint32_t>(((pal.alphaBits >> (i * 4)) & 15) * 17) << 24;
+  case SurfaceFormat::k_DXT4_5:
+    return (pal.color[(pal.colorBits >> (i * 2)) & 3] & 0x00FFFFFF) |
+           static_cast<uint32_t>(pal.alpha[(pal.alphaBits >> (i * 3)) & 7]) << 24;
+  case SurfaceFormat::k_DXN:
+    return 0xFF000000 | static_cast<uint32_t>(pal.alpha[(pal.alphaBits >> (i * 3)) & 7]) << 16 |
+           static_cast<uint32_t>(pal.green[(pal.greenBits >> (i * 3)) & 7]) << 8;
+  default:
+    return 0;
+  }
+}
+
+// Scalar path, also handles the partial blocks on the right/bottom edges
+inline void decodeBlock(const BlockPalette& pal, SurfaceFormat format, uint32_t* dst, uint32_t pitch,
+                        uint32_t w, uint32_t h) {
+  for (uint32_t y = 0; y < h; y++) {
+    for (uint32_t x = 0; x < w; x++)
+      dst[y * pitch + x] = decodeTexel(pal, format, y * 4 + x);
+  }
+}
+
+// Per texel palette indices, what the SIMD kernels look up from.
+// alpha holds the 4 bit alpha itself for BC2, the 3 bit index for BC3/BC5.
+inline void unpackIndices(const BlockPalette& pal, SurfaceFormat format, uint32_t color[16], uint32_t alpha[16],
+                          uint32_t green[16]) {
+  const uint32_t alphaShift = format == SurfaceFormat::k_DXT2_3 ? 4 : 3;
+  const uint64_t alphaMask = (1u << alphaShift) - 1;
+  for (uint32_t i = 0; i < 16; i++) {
+    color[i] = (pal.colorBits >> (i * 2)) & 3;
+    alpha[i] = static_cast<uint32_t>((pal.alphaBits >> (i * alphaShift)) & alphaMask);
+    green[i] = static_cast<uint32_t>((pal.greenBits >> (i * 3)) & 7);
+  }
+}
@@ -0,0 +1,173 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "bc_encode.h"
+#include "bc_block.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Mode 6 interpolation weights, out of 64
+constexpr uint32_t bc7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+uint32_t channel(uint32_t pixel, uint32_t c) {
+  // R, G, B, A
+  constexpr uint32_t shifts[4] = {16, 8, 0, 24};
+  return (pixel >> shifts[c]) & 0xFF;
+}
+
+uint32_t distance(uint32_t a, uint32_t b, uint32_t channels) {
+  uint32_t sum = 0;
+  for (uint32_t c = 0; c < channels; c++) {
+    const int32_t d = static_cast<int32_t>(channel(a, c)) - static_cast<int32_t>(channel(b, c));
+    sum += static_cast<uint32_t>(d * d);
+  }
+  return sum;
+}
+
+uint32_t pack565(uint32_t r, uint32_t g, uint32_t b) {
+  return ((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255);
+}
+
+void encodeBC1(const uint32_t texels[16], uint8_t* out) {
+  uint32_t lo[3] = {255, 255, 255}, hi[3] = {0, 0, 0};
+  for (uint32_t i = 0; i < 16; i++) {
+    for (uint32_t c = 0; c < 3; c++) {
+      lo[c] = std::min(lo[c], channel(texels[i], c));
+      hi[c] = std::max(hi[c], channel(texels[i], c));
+    }
+  }
+  // Quantizing keeps the order, so c0 >= c1 and the block is in 4 color mode unless they're equal
+  const uint32_t c0 = pack565(hi[0], hi[1], hi[2]);
+  const uint32_t c1 = pack565(lo[0], lo[1], lo[2]);
+  uint32_t bits = 0;
+  if (c0 != c1) {
+    const uint32_t p0 = expand565(c0);
+    const uint32_t p1 = expand565(c1);
+    const uint32_t palette[4] = {p0, p1, lerpColor(p0, p1, 2, 1, 3), lerpColor(p0, p1, 1, 2, 3)};
+    for (uint32_t i = 0; i < 16; i++) {
+      uint32_t best = 0, bestError = distance(texels[i], palette[0], 3);
+      for (uint32_t j = 1; j < 4; j++) {
+        const uint32_t error = distance(texels[i], palette[j], 3);
+        if (error < bestError) {
+          best = j;
+          bestError = error;
+        }
+      }
+      bits |= best << (i * 2);
+    }
+  }
+  const uint32_t colors = c0 | c1 << 16;
+  std::memcpy(out, &colors, 4);
+  std::memcpy(out + 4, &bits, 4);
+}
+
+// 7 bit endpoint and p-bit closest to an RGBA endpoint
+void quantizeEndpoint(const uint32_t target[4], uint32_t v7[4], uint32_t& pbit) {
+  uint32_t bestError = UINT32_MAX;
+  for (uint32_t p = 0; p < 2; p++) {
+    uint32_t error = 0, v[4];
+    for (uint32_t c = 0; c < 4; c++) {
+      v[c] = std::min((target[c] - p + 1) >> 1, 127u);
+      const int32_t d = static_cast<int32_t>(v[c] << 1 | p) - static_cast<int32_t>(target[c]);
+      error += static_cast<uint32_t>(d * d);
+    }
+    if (error < bestError) {
+      bestError = error;
+      pbit = p;
+      std::copy(v, v + 4, v7);
+    }
+  }
+}
+
+class BitWriter {
+public:
+  explicit BitWriter(uint8_t* out) : out(out) {
+    std::memset(out, 0, 16);
+  }
+  void put(uint32_t value, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++, position++)
+      out[position >> 3] |= static_cast<uint8_t>(((value >> i) & 1) << (position & 7));
+  }
+
+private:
+  uint8_t* out;
+  uint32_t position = 0;
+};
+
+void encodeBC7(const uint32_t texels[16], uint8_t* out) {
+  uint32_t lo[4] = {255, 255, 255, 255}, hi[4] = {0, 0, 0, 0};
+  for (uint32_t i = 0; i < 16; i++) {
+    for (uint32_t c = 0; c < 4; c++) {
+      lo[c] = std::min(lo[c], channel(texels[i], c));
+      hi[c] = std::max(hi[c], channel(texels[i], c));
+    }
+  }
+  uint32_t e[2][4], p[2];
+  quantizeEndpoint(lo, e[0], p[0]);
+  quantizeEndpoint(hi, e[1], p[1]);
+  uint32_t palette[16];
+  for (uint32_t j = 0; j < 16; j++) {
+    palette[j] = 0;
+    for (uint32_t c = 0; c < 4; c++) {
+      const uint32_t a = e[0][c] << 1 | p[0];
+      const uint32_t b = e[1][c] << 1 | p[1];
+      const uint32_t value = ((64 - bc7Weights[j]) * a + bc7Weights[j] * b + 32) >> 6;
+      palette[j] |= value << (c == 3 ? 24 : 16 - c * 8);
+    }
+  }
+  uint32_t indices[16];
+  for (uint32_t i = 0; i < 16; i++) {
+    uint32_t best = 0, bestError = distance(texels[i], palette[0], 4);
+    for (uint32_t j = 1; j < 16; j++) {
+      const uint32_t error = distance(texels[i], palette[j], 4);
+      if (error < bestError) {
+        best = j;
+        bestError = error;
+      }
+    }
+    indices[i] = best;
+  }
+  // The first index only has 3 bits, swapping the endpoints mirrors the weights
+  if (indices[0] & 8) {
+    std::swap(e[0], e[1]);
+    std::swap(p[0], p[1]);
+    for (uint32_t& index : indices)
+      index = 15 - index;
+  }
+
+  BitWriter bits(out);
+  bits.put(1 << 6, 7); // Mode 6
+  for (uint32_t c = 0; c < 4; c++) {
+    bits.put(e[0][c], 7);
+    bits.put(e[1][c], 7);
+  }
+  bits.put(p[0], 1);
+  bits.put(p[1], 1);
+  bits.put(indices[0], 3);
+  for (uint32_t i = 1; i < 16; i++)
+    bits.put(indices[i], 4);
+}
+
+} // namespace
+
+uint32_t encodedBlockSize(BlockEncoding encoding) {
+  return encoding == BlockEncoding::BC1 ? 8 : 16;
+}
+
+void encodeBlocks(const uint32_t* src, uint8_t* dst, uint32_t width, uint32_t height, BlockEncoding encoding) {
+  const uint32_t blockSize = encodedBlockSize(encoding);
+  uint32_t texels[16];
+  for (uint32_t by = 0; by < height / 4; by++) {
+    for (uint32_t bx = 0; bx < width / 4; bx++) {
+      for (uint32_t y = 0; y < 4; y++)
+        std::memcpy(texels + y * 4, src + static_cast<uint64_t>(by * 4 + y) * width + bx * 4, 16);
+      if (encoding == BlockEncoding::BC1)
+        encodeBC1(texels, dst);
+      else
+        encodeBC7(texels, dst);
+      dst += blockSize;
+    }
+  }
+}
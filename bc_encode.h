@@ -0,0 +1,21 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+
+// Block compression of detiled frames, for the timeline viewer's frame cache. Built for speed over quality:
+// BC1 takes the bounding box of a block's colors as its endpoints (opaque, alpha is dropped), BC7 only
+// uses mode 6, the bounding box of RGBA with 7 bit endpoints and a p-bit each. Indices are picked by
+// exhaustive search in integer math, so the GPU encoder (bcEncodeComputeShaderSource in main.cpp) makes
+// the exact same blocks.
+enum class BlockEncoding : uint8_t {
+  BC1, // 8 bytes per block, 0.5 byte per pixel
+  BC7, // 16 bytes per block, 1 byte per pixel
+};
+
+uint32_t encodedBlockSize(BlockEncoding encoding);
+
+// src is width * height ARGB pixels (same packing as the framebuffer), both multiples of 4.
+// dst gets the blocks left to right, top to bottom.
+void encodeBlocks(const uint32_t* src, uint8_t* dst, uint32_t width, uint32_t height, BlockEncoding encoding);
@@ -0,0 +1,117 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "cpu.h"
+
+#ifdef XE_ARCH_X64
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#include <cstdint>
+#include <initializer_list>
+
+#ifdef XE_ARCH_X64
+static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) {
+#ifdef _MSC_VER
+  __cpuidex(reinterpret_cast<int*>(regs), leaf, subleaf);
+#else
+  __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static uint64_t xgetbv() {
+#ifdef _MSC_VER
+  return _xgetbv(0);
+#else
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+static CpuFeatures detect() {
+  CpuFeatures features;
+#ifdef XE_ARCH_X64
+  uint32_t regs[4];
+  cpuid(0, 0, regs);
+  const uint32_t maxLeaf = regs[0];
+  cpuid(1, 0, regs);
+  // The OS has to save YMM state for us to touch AVX at all
+  const bool osxsave = (regs[2] >> 27) & 1;
+  const bool avx = (regs[2] >> 28) & 1;
+  const uint64_t xcr0 = osxsave ? xgetbv() : 0;
+  const bool ymm = avx && (xcr0 & 0x6) == 0x6;
+  // Same for the opmask and upper ZMM state
+  const bool zmm = ymm && (xcr0 & 0xE0) == 0xE0;
+  if (maxLeaf >= 7) {
+    cpuid(7, 0, regs);
+    features.avx2 = ymm && ((regs[1] >> 5) & 1);
+    features.avx512f = zmm && ((regs[1] >> 16) & 1);
+  }
+#endif
+  return features;
+}
+
+const CpuFeatures& cpuFeatures() {
+  static const CpuFeatures features = detect();
+  return features;
+}
+
+const char* cpuBackendName(CpuBackend backend) {
+  switch (backend) {
+  case CpuBackend::SSE2:
+    return "SSE2";
+  case CpuBackend::AVX2:
+    return "AVX2";
+  case CpuBackend::AVX512:
+    return "AVX-512";
+  case CpuBackend::NEON:
+    return "NEON";
+  case CpuBackend::JIT:
+    return "JIT";
+  default:
+    return "Scalar";
+  }
+}
+
+bool cpuBackendSupported(CpuBackend backend) {
+  switch (backend) {
+  // Baseline on their architectures
+  case CpuBackend::SSE2:
+#ifdef XE_ARCH_X64
+    return true;
+#else
+    return false;
+#endif
+  case CpuBackend::JIT:
+#ifdef XE_ARCH_X64
+    return true;
+#else
+    return false;
+#endif
+  case CpuBackend::NEON:
+#ifdef XE_ARCH_ARM64
+    return true;
+#else
+    return false;
+#endif
+  case CpuBackend::AVX2:
+    return cpuFeatures().avx2;
+  case CpuBackend::AVX512:
+    return cpuFeatures().avx512f;
+  default:
+    return true;
+  }
+}
+
+CpuBackend bestCpuBackend() {
+  for (const CpuBackend backend : {CpuBackend::AVX512, CpuBackend::AVX2, CpuBackend::SSE2, CpuBackend::NEON}) {
+    if (cpuBackendSupported(backend))
+      return backend;
+  }
+  return CpuBackend::Scalar;
+}
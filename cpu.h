@@ -0,0 +1,44 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define XE_ARCH_X64 1
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define XE_ARCH_ARM64 1
+#endif
+
+// MSVC lets you use any intrinsic anywhere, GCC/Clang need the target per function
+#if defined(_MSC_VER) && !defined(__clang__)
+#define XE_TARGET(x)
+#else
+#define XE_TARGET(x) __attribute__((target(x)))
+#endif
+
+struct CpuFeatures {
+  bool avx2 = false;
+  bool avx512f = false;
+};
+
+// Detected once, on first use
+const CpuFeatures& cpuFeatures();
+
+// CPU code paths for the detile/decode kernels. Everything but Scalar and JIT is a SIMD target built into
+// the binary (see simd.cpp), the one to use is picked at runtime from cpuFeatures().
+enum class CpuBackend : uint8_t {
+  Scalar,
+  SSE2,
+  AVX2,
+  AVX512,
+  NEON,
+  JIT, // Detile code generated per width (detile_jit.h), x64 only, never picked on its own
+};
+
+const char* cpuBackendName(CpuBackend backend);
+bool cpuBackendSupported(CpuBackend backend);
+// Fastest one this CPU can run
+CpuBackend bestCpuBackend();
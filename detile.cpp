@@ -0,0 +1,129 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "detile.h"
+#include "detile_jit.h"
+#include "simd.h"
+#include "xenos.h"
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+static void detileScalar(const uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height) {
+  const uint32_t tiledWidth = TILE(width);
+  for (uint32_t y = 0; y < height; y++) {
+    uint32_t* row = dst + static_cast<uint64_t>(y) * width;
+    FbScanlineWalker walker(tiledWidth, 0, y);
+    for (uint32_t x = 0; x < width; x++) {
+      row[x] = src[walker.address()];
+      walker.advance();
+    }
+  }
+}
+
+void detileFramebuffer(const uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height, CpuBackend backend) {
+  // The JIT falls back to the best SIMD target when it can't generate code
+  if (backend == CpuBackend::JIT) {
+    if (detileFramebufferJIT(src, dst, width, height))
+      return;
+    backend = bestCpuBackend();
+  }
+  if (const SimdKernels* kernels = simdKernels(backend))
+    kernels->detileFramebuffer(src, dst, width, height);
+  else
+    detileScalar(src, dst, width, height);
+}
+
+static CpuBackend detileBackend = bestCpuBackend();
+
+void setDetileBackend(CpuBackend backend) {
+  detileBackend = backend;
+}
+
+void detileFramebuffer(const uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height) {
+  detileFramebuffer(src, dst, width, height, detileBackend);
+}
+
+// In place detiling. A 32 row band covers the same words in the tiled layout and in a linear layout
+// with a TILE(width) pitch, so the permutation never leaves a band and is the same for every band.
+// Cycles are stored by their first element only, fixed points are left out.
+template <class Perm>
+static std::vector<uint32_t> cycleLeaders(uint32_t size, Perm perm) {
+  std::vector<uint32_t> leaders;
+  std::vector<bool> visited(size);
+  for (uint32_t start = 0; start < size; start++) {
+    if (visited[start])
+      continue;
+    visited[start] = true;
+    if (perm(start) == start)
+      continue;
+    leaders.push_back(start);
+    for (uint32_t i = perm(start); i != start; i = perm(i))
+      visited[i] = true;
+  }
+  return leaders;
+}
+
+// data[i] = old data[perm(i)] for every i, moving elements of stride words
+template <class Perm>
+static void applyCycles(uint32_t* data, uint32_t stride, const std::vector<uint32_t>& leaders, Perm perm) {
+  uint32_t saved[32];
+  for (const uint32_t start : leaders) {
+    std::memcpy(saved, data + static_cast<uint64_t>(start) * stride, stride * sizeof(uint32_t));
+    uint32_t i = start;
+    for (uint32_t next = perm(i); next != start; i = next, next = perm(i))
+      std::memcpy(data + static_cast<uint64_t>(i) * stride, data + static_cast<uint64_t>(next) * stride,
+                  stride * sizeof(uint32_t));
+    std::memcpy(data + static_cast<uint64_t>(i) * stride, saved, stride * sizeof(uint32_t));
+  }
+}
+
+enum class CycleSet : uint8_t {
+  Band,      // Pixels of a whole band
+  Tile,      // Pixels of one tile, tiled to 32x32 linear
+  TileRows,  // 32 pixel tile rows of a band, tile after tile to row after row
+};
+
+static std::mutex cycleMutex;
+static std::map<std::pair<CycleSet, uint32_t>, std::vector<uint32_t>> cycleCache;
+
+template <class Perm>
+static const std::vector<uint32_t>& cachedCycles(CycleSet set, uint32_t tiledWidth, uint32_t size, Perm perm) {
+  const std::lock_guard lock(cycleMutex);
+  auto it = cycleCache.find({set, tiledWidth});
+  if (it == cycleCache.end())
+    it = cycleCache.emplace(std::make_pair(set, tiledWidth), cycleLeaders(size, perm)).first;
+  return it->second;
+}
+
+void detileFramebufferInPlace(uint32_t* buffer, uint32_t width, uint32_t height, bool blocked) {
+  const uint32_t tiledWidth = TILE(width);
+  const uint32_t bands = TILE(height) / 32;
+  const uint32_t bandSize = tiledWidth * 32;
+  if (blocked) {
+    const auto tilePerm = [](uint32_t i) { return xeFbConvert(32, i * 4); };
+    const uint32_t tilesX = tiledWidth / 32;
+    // Row r of tile t moves to row r of the band, at column t
+    const auto rowPerm = [tilesX](uint32_t i) { return (i % tilesX) * 32 + i / tilesX; };
+    const std::vector<uint32_t>& tileCycles = cachedCycles(CycleSet::Tile, 32, 1024, tilePerm);
+    const std::vector<uint32_t>& rowCycles = cachedCycles(CycleSet::TileRows, tiledWidth, tilesX * 32, rowPerm);
+    for (uint32_t band = 0; band < bands; band++) {
+      uint32_t* data = buffer + static_cast<uint64_t>(band) * bandSize;
+      for (uint32_t tile = 0; tile < tilesX; tile++)
+        applyCycles(data + tile * 1024, 1, tileCycles, tilePerm);
+      applyCycles(data, 32, rowCycles, rowPerm);
+    }
+  } else {
+    const auto bandPerm = [tiledWidth](uint32_t i) { return xeFbConvert(tiledWidth, i * 4); };
+    const std::vector<uint32_t>& bandCycles = cachedCycles(CycleSet::Band, tiledWidth, bandSize, bandPerm);
+    for (uint32_t band = 0; band < bands; band++)
+      applyCycles(buffer + static_cast<uint64_t>(band) * bandSize, 1, bandCycles, bandPerm);
+  }
+  // Drop the padding columns, rows only ever move down in memory
+  if (width != tiledWidth) {
+    for (uint32_t y = 1; y < height; y++)
+      std::memmove(buffer + static_cast<uint64_t>(y) * width, buffer + static_cast<uint64_t>(y) * tiledWidth,
+                   width * sizeof(uint32_t));
+  }
+}
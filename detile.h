@@ -0,0 +1,21 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+
+#include "cpu.h"
+
+// Detiles a resolved 32bpp framebuffer into width * height linear ARGB pixels.
+// src holds TILE(width) * TILE(height) tiled pixels.
+void detileFramebuffer(const uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height);
+void detileFramebuffer(const uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height, CpuBackend backend);
+// Backend of the overload without one, bestCpuBackend() unless set. Not thread safe, set it up front.
+void setDetileBackend(CpuBackend backend);
+
+// Detiles in place, without a second surface sized buffer. buffer holds TILE(width) * TILE(height) tiled
+// pixels on entry and width * height linear pixels on exit, the rest of it is left unspecified.
+// The permutation is applied by following its cycles, which are cached per tiled width.
+// blocked permutes each tile on its own and then moves whole 32 pixel tile rows, which keeps the
+// word sized moves inside a 4KB tile, unblocked follows the cycles of a whole 32 row band.
+void detileFramebufferInPlace(uint32_t* buffer, uint32_t width, uint32_t height, bool blocked = true);
@@ -0,0 +1,183 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "detile_jit.h"
+#include "cpu.h"
+#include "xenos.h"
+
+#ifdef XE_ARCH_X64
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// One scanline: src points at its first tile row (tile 0, row pair and y & 1 already applied), dst at its
+// first pixel. There's one for each y & 8, which swaps the 16 pixel halves of every tile row.
+using RowFunction = void (*)(const uint32_t* src, uint32_t* dst);
+
+// The arguments stay in their registers and serve as the bases of every move, nothing to save
+#ifdef _WIN32
+constexpr uint8_t srcRegister = 1; // rcx
+constexpr uint8_t dstRegister = 2; // rdx
+#else
+constexpr uint8_t srcRegister = 7; // rdi
+constexpr uint8_t dstRegister = 6; // rsi
+#endif
+
+// Just the SSE2 moves the row functions are made of, between xmm0-3 and [base + disp]
+class Emitter {
+public:
+  // 16 (movdqu), 8 (movq) or 4 (movd) bytes
+  void load(uint32_t bytes, uint8_t xmm, int32_t disp) {
+    if (bytes == 16)
+      emit({0xF3, 0x0F, 0x6F});
+    else if (bytes == 8)
+      emit({0xF3, 0x0F, 0x7E});
+    else
+      emit({0x66, 0x0F, 0x6E});
+    operand(xmm, srcRegister, disp);
+  }
+
+  void store(uint32_t bytes, uint8_t xmm, int32_t disp) {
+    if (bytes == 16)
+      emit({0xF3, 0x0F, 0x7F});
+    else if (bytes == 8)
+      emit({0x66, 0x0F, 0xD6});
+    else
+      emit({0x66, 0x0F, 0x7E});
+    operand(xmm, dstRegister, disp);
+  }
+
+  void ret() {
+    emit({0xC3});
+  }
+
+  const std::vector<uint8_t>& bytes() const {
+    return code;
+  }
+
+private:
+  void emit(std::initializer_list<uint8_t> bytes) {
+    code.insert(code.end(), bytes);
+  }
+
+  // ModRM with the shortest displacement. Neither base is rsp or rbp, so no SIB and no special cases.
+  void operand(uint8_t reg, uint8_t base, int32_t disp) {
+    const uint8_t mod = disp == 0 ? 0 : (disp >= -128 && disp < 128) ? 1 : 2;
+    code.push_back(static_cast<uint8_t>(mod << 6 | reg << 3 | base));
+    if (mod == 1) {
+      code.push_back(static_cast<uint8_t>(disp));
+    } else if (mod == 2) {
+      for (int i = 0; i < 4; i++)
+        code.push_back(static_cast<uint8_t>(static_cast<uint32_t>(disp) >> (i * 8)));
+    }
+  }
+
+  std::vector<uint8_t> code;
+};
+
+std::vector<uint8_t> generateRow(uint32_t width, bool flip) {
+  struct Move {
+    uint32_t bytes;
+    int32_t src;
+    int32_t dst;
+  };
+  std::vector<Move> moves;
+  for (uint32_t x = 0; x < width; x += 4) {
+    // Word bits 0-1 are x & 3 and bits 3-5 are x >> 2, with bit 5 flipped
+    const uint32_t group = ((x >> 2) & 7) ^ (flip ? 4 : 0);
+    const uint32_t word = (x >> 5) * 1024 + group * 8;
+    const uint32_t count = std::min(4u, width - x);
+    if (count == 3) {
+      moves.push_back({8, static_cast<int32_t>(word * 4), static_cast<int32_t>(x * 4)});
+      moves.push_back({4, static_cast<int32_t>(word * 4 + 8), static_cast<int32_t>(x * 4 + 8)});
+    } else {
+      moves.push_back({count * 4, static_cast<int32_t>(word * 4), static_cast<int32_t>(x * 4)});
+    }
+  }
+  // Four loads ahead of their stores
+  Emitter emitter;
+  for (size_t i = 0; i < moves.size(); i += 4) {
+    const size_t end = std::min(moves.size(), i + 4);
+    for (size_t j = i; j < end; j++)
+      emitter.load(moves[j].bytes, static_cast<uint8_t>(j - i), moves[j].src);
+    for (size_t j = i; j < end; j++)
+      emitter.store(moves[j].bytes, static_cast<uint8_t>(j - i), moves[j].dst);
+  }
+  emitter.ret();
+  return emitter.bytes();
+}
+
+// Copies code into memory that's made executable once it's written (never writable and executable at
+// once). Generated code lives as long as the process, there's a handful of widths at most.
+void* installCode(const std::vector<uint8_t>& code) {
+#ifdef _WIN32
+  void* memory = VirtualAlloc(nullptr, code.size(), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+  if (!memory)
+    return nullptr;
+  std::memcpy(memory, code.data(), code.size());
+  DWORD old;
+  if (!VirtualProtect(memory, code.size(), PAGE_EXECUTE_READ, &old)) {
+    VirtualFree(memory, 0, MEM_RELEASE);
+    return nullptr;
+  }
+  FlushInstructionCache(GetCurrentProcess(), memory, code.size());
+  return memory;
+#else
+  void* memory = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED)
+    return nullptr;
+  std::memcpy(memory, code.data(), code.size());
+  if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) != 0) {
+    munmap(memory, code.size());
+    return nullptr;
+  }
+  return memory;
+#endif
+}
+
+std::mutex rowMutex;
+// Both row functions for a width, nullptr ones if the code couldn't be installed
+std::map<uint32_t, std::array<RowFunction, 2>> rowCache;
+
+const std::array<RowFunction, 2>& rowFunctions(uint32_t width) {
+  const std::lock_guard lock(rowMutex);
+  auto it = rowCache.find(width);
+  if (it == rowCache.end()) {
+    std::array<RowFunction, 2> rows;
+    for (int flip = 0; flip < 2; flip++)
+      rows[flip] = reinterpret_cast<RowFunction>(installCode(generateRow(width, flip != 0)));
+    it = rowCache.emplace(width, rows).first;
+  }
+  return it->second;
+}
+
+} // namespace
+
+bool detileFramebufferJIT(const uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height) {
+  const std::array<RowFunction, 2>& rows = rowFunctions(width);
+  if (!rows[0] || !rows[1])
+    return false;
+  const uint32_t tiledWidth = TILE(width);
+  for (uint32_t y = 0; y < height; y++)
+    rows[(y >> 3) & 1](src + static_cast<uint64_t>(y & ~31u) * tiledWidth + (y & 30) * 32 + (y & 1) * 4,
+                       dst + static_cast<uint64_t>(y) * width);
+  return true;
+}
+
+#else
+
+bool detileFramebufferJIT(const uint32_t*, uint32_t*, uint32_t, uint32_t) {
+  return false;
+}
+
+#endif
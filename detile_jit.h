@@ -0,0 +1,12 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+
+// x64 detiler generated at runtime for one exact surface width. A scanline is a straight run of 16 byte
+// SSE2 moves at constant offsets, one per 4 pixel group, with no loop over the tiles and the partial tile
+// of an odd width handled by narrower moves instead of a masked tail. The code for a width is generated
+// on first use and kept for the rest of the run.
+// Same contract as detileFramebuffer (detile.h). false, with nothing written, where generated code can't run.
+bool detileFramebufferJIT(const uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height);
@@ -0,0 +1,205 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "direct_file.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <malloc.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+// Linux 6.14, older headers don't know it yet. Kernels without it fail the write with EOPNOTSUPP.
+#if defined(__linux__) && !defined(RWF_DONTCACHE)
+#define RWF_DONTCACHE 0x00000080
+#endif
+
+DirectFileBuf::DirectFileBuf() {
+#ifdef _WIN32
+  pool = static_cast<uint8_t*>(_aligned_malloc(bufferSize * bufferCount, alignment));
+#else
+  pool = static_cast<uint8_t*>(std::aligned_alloc(alignment, bufferSize * bufferCount));
+#endif
+}
+
+DirectFileBuf::~DirectFileBuf() {
+  close();
+#ifdef _WIN32
+  _aligned_free(pool);
+#else
+  std::free(pool);
+#endif
+}
+
+bool DirectFileBuf::open(const char* path) {
+#ifdef _WIN32
+  file = CreateFileA(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING,
+                     nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    file = nullptr;
+  const bool opened = file != nullptr;
+  mode = Mode::Direct;
+#else
+  fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  const bool opened = fd >= 0;
+#ifdef __linux__
+  mode = Mode::DontCache;
+#elif defined(F_NOCACHE)
+  // macOS, the closest thing to O_DIRECT and no alignment rules
+  if (opened)
+    fcntl(fd, F_NOCACHE, 1);
+  mode = Mode::Buffered;
+#else
+  mode = Mode::Buffered;
+#endif
+#endif
+  if (!opened || !pool) {
+    std::cout << "Failed to open " << path << " for writing!" << std::endl;
+    return false;
+  }
+
+  freeBuffers.clear();
+  for (uint32_t i = 1; i < bufferCount; i++)
+    freeBuffers.push_back(i);
+  current = 0;
+  offset = 0;
+  stopping = false;
+  failed = false;
+  setp(reinterpret_cast<char*>(buffer(0)), reinterpret_cast<char*>(buffer(0) + bufferSize));
+  writer = std::thread(&DirectFileBuf::writerLoop, this);
+  return true;
+}
+
+DirectFileBuf::int_type DirectFileBuf::overflow(int_type ch) {
+  if (!writer.joinable())
+    return traits_type::eof();
+  submit();
+  if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+  }
+  return failed ? traits_type::eof() : traits_type::not_eof(ch);
+}
+
+// Queues the current buffer and switches to a free one, waits if the writer is behind on all of them
+void DirectFileBuf::submit() {
+  const size_t size = static_cast<size_t>(pptr() - pbase());
+  if (!size)
+    return;
+  std::unique_lock lock(mutex);
+  queue.push_back({current, size, offset});
+  offset += size;
+  cv.notify_all();
+  cv.wait(lock, [this] { return !freeBuffers.empty(); });
+  current = freeBuffers.back();
+  freeBuffers.pop_back();
+  setp(reinterpret_cast<char*>(buffer(current)), reinterpret_cast<char*>(buffer(current) + bufferSize));
+}
+
+void DirectFileBuf::writerLoop() {
+  std::unique_lock lock(mutex);
+  while (true) {
+    cv.wait(lock, [this] { return stopping || !queue.empty(); });
+    if (queue.empty())
+      return;
+    const Pending pending = queue.front();
+    queue.pop_front();
+    lock.unlock();
+    if (!failed && !writeBlock(buffer(pending.index), pending.size, pending.offset))
+      failed = true;
+    lock.lock();
+    freeBuffers.push_back(pending.index);
+    cv.notify_all();
+  }
+}
+
+bool DirectFileBuf::writeAll(const uint8_t* data, size_t size, uint64_t at) {
+#ifdef _WIN32
+  OVERLAPPED overlapped = {};
+  overlapped.Offset = static_cast<DWORD>(at);
+  overlapped.OffsetHigh = static_cast<DWORD>(at >> 32);
+  DWORD written = 0;
+  return WriteFile(file, data, static_cast<DWORD>(size), &written, &overlapped) && written == size;
+#else
+  while (size) {
+    const ssize_t n = pwrite(fd, data, size, static_cast<off_t>(at));
+    if (n <= 0)
+      return false;
+    data += n;
+    size -= static_cast<size_t>(n);
+    at += static_cast<uint64_t>(n);
+  }
+  return true;
+#endif
+}
+
+bool DirectFileBuf::writeBlock(uint8_t* data, size_t size, uint64_t at) {
+#ifdef __linux__
+  if (mode == Mode::DontCache) {
+    iovec iov = {data, size};
+    const ssize_t n = pwritev2(fd, &iov, 1, static_cast<off_t>(at), RWF_DONTCACHE);
+    if (n == static_cast<ssize_t>(size))
+      return true;
+    if (n >= 0)
+      return writeAll(data + n, size - static_cast<size_t>(n), at + static_cast<uint64_t>(n));
+    if (errno != EOPNOTSUPP && errno != EINVAL)
+      return false;
+    // Older kernel, switch this file over to O_DIRECT
+    const int flags = fcntl(fd, F_GETFL);
+    mode = flags >= 0 && fcntl(fd, F_SETFL, flags | O_DIRECT) == 0 ? Mode::Direct : Mode::Buffered;
+  }
+#endif
+  if (mode == Mode::Direct) {
+    // Only the last block can be short, it's padded out and the file is truncated back on close
+    const size_t padded = (size + alignment - 1) & ~(alignment - 1);
+    std::memset(data + size, 0, padded - size);
+    if (writeAll(data, padded, at))
+      return true;
+#ifdef __linux__
+    // Filesystems without O_DIRECT support fail the write, not the fcntl
+    if (errno != EINVAL)
+      return false;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+    mode = Mode::Buffered;
+#else
+    return false;
+#endif
+  }
+  return writeAll(data, size, at);
+}
+
+bool DirectFileBuf::close() {
+  if (!writer.joinable())
+    return false;
+  submit();
+  {
+    const std::lock_guard lock(mutex);
+    stopping = true;
+  }
+  cv.notify_all();
+  writer.join();
+  setp(nullptr, nullptr);
+
+  // Drop the padding of the last O_DIRECT block
+  bool ok = !failed;
+#ifdef _WIN32
+  FILE_END_OF_FILE_INFO end;
+  end.EndOfFile.QuadPart = static_cast<LONGLONG>(offset);
+  ok = SetFileInformationByHandle(file, FileEndOfFileInfo, &end, sizeof(end)) && ok;
+  CloseHandle(file);
+  file = nullptr;
+#else
+  ok = ftruncate(fd, static_cast<off_t>(offset)) == 0 && ok;
+  ok = ::close(fd) == 0 && ok;
+  fd = -1;
+#endif
+  return ok;
+}
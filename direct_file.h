@@ -0,0 +1,93 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+// Output file that stays out of the page cache, for batch exports that would otherwise evict everything
+// else on the host. Writes use RWF_DONTCACHE when the kernel has it, O_DIRECT (FILE_FLAG_NO_BUFFERING on
+// Windows) otherwise. The stream fills a small pool of aligned buffers, full ones are written by a
+// background thread while the next one is being filled.
+class DirectFileBuf : public std::streambuf {
+public:
+  DirectFileBuf();
+  ~DirectFileBuf() override;
+
+  bool open(const char* path);
+  // Writes what's left and waits for it, false if any write failed
+  bool close();
+
+protected:
+  int_type overflow(int_type ch) override;
+
+private:
+  // A filled buffer, waiting for the writer thread
+  struct Pending {
+    uint32_t index;
+    size_t size;
+    uint64_t offset;
+  };
+
+  enum class Mode : uint8_t {
+    DontCache,
+    Direct,
+    Buffered, // The filesystem takes neither (tmpfs and the like)
+  };
+
+  static constexpr size_t bufferSize = 1 << 20;
+  static constexpr uint32_t bufferCount = 4;
+  static constexpr size_t alignment = 4096;
+
+  uint8_t* buffer(uint32_t index) const {
+    return pool + index * bufferSize;
+  }
+
+  void submit();
+  void writerLoop();
+  bool writeBlock(uint8_t* data, size_t size, uint64_t offset);
+  bool writeAll(const uint8_t* data, size_t size, uint64_t offset);
+
+  uint8_t* pool = nullptr;
+  uint32_t current = 0;
+  uint64_t offset = 0; // File offset of the current buffer
+  Mode mode = Mode::DontCache;
+#ifdef _WIN32
+  void* file = nullptr;
+#else
+  int fd = -1;
+#endif
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<Pending> queue;
+  std::vector<uint32_t> freeBuffers;
+  bool stopping = false;
+  std::atomic<bool> failed = false;
+  std::thread writer;
+};
+
+class DirectFile : public std::ostream {
+public:
+  DirectFile() : std::ostream(&buf) {}
+
+  bool open(const char* path) {
+    if (!buf.open(path))
+      setstate(std::ios::failbit);
+    return good();
+  }
+
+  bool close() {
+    return buf.close() && good();
+  }
+
+private:
+  DirectFileBuf buf;
+};
@@ -0,0 +1,83 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "frame_cache.h"
+
+#include <algorithm>
+#include <iostream>
+
+bool FrameCache::init(int width, int height, GLenum format, size_t count, GLuint (*makeSRGB)(GLuint)) {
+  GLint maxLayers = 0;
+  glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+  count = std::min(count, static_cast<size_t>(maxLayers));
+  // Core GL can't tell how much VRAM is free, an allocation that doesn't fit fails with GL_OUT_OF_MEMORY
+  while (glGetError() != GL_NO_ERROR) {
+  }
+  while (true) {
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, format, width, height, static_cast<GLsizei>(count));
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    if (glGetError() == GL_NO_ERROR)
+      break;
+    glDeleteTextures(1, &texture);
+    texture = 0;
+    if (count == 1) {
+      std::cout << "Not enough video memory for the frame cache" << std::endl;
+      return false;
+    }
+    count /= 2;
+  }
+
+  layers.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    Layer& layer = layers[i];
+    glGenTextures(1, &layer.view);
+    glTextureView(layer.view, GL_TEXTURE_2D, texture, format, 0, 1, static_cast<GLuint>(i), 1);
+    glBindTexture(GL_TEXTURE_2D, layer.view);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (makeSRGB)
+      layer.srgbView = makeSRGB(layer.view);
+    layer.use = recent.insert(recent.end(), static_cast<int>(i));
+  }
+  return true;
+}
+
+void FrameCache::destroy() {
+  for (const Layer& layer : layers) {
+    glDeleteTextures(1, &layer.view);
+    if (layer.srgbView)
+      glDeleteTextures(1, &layer.srgbView);
+  }
+  glDeleteTextures(1, &texture);
+  texture = 0;
+  layers.clear();
+  recent.clear();
+  frameLayers.clear();
+}
+
+int FrameCache::find(size_t frame) {
+  const auto it = frameLayers.find(frame);
+  if (it == frameLayers.end())
+    return -1;
+  recent.splice(recent.begin(), recent, layers[it->second].use);
+  return it->second;
+}
+
+bool FrameCache::contains(size_t frame) const {
+  return frameLayers.count(frame) != 0;
+}
+
+int FrameCache::insert(size_t frame) {
+  const int index = recent.back();
+  Layer& layer = layers[index];
+  if (layer.frame != noFrame)
+    frameLayers.erase(layer.frame);
+  layer.frame = frame;
+  frameLayers[frame] = index;
+  recent.splice(recent.begin(), recent, layer.use);
+  return index;
+}
@@ -0,0 +1,60 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include <KHR/khrplatform.h>
+#include <glad/glad.h>
+
+// Detiled frames kept on the GPU for the timeline viewer, one per layer of a texture array (R32UI like the
+// detiled texture, or block compressed), least recently used layer reused first. Every layer has a 2D view
+// (and an sRGB one if asked for) so the present pass samples a cached frame like any other texture,
+// showing one is a bind.
+// The GL objects need the context, destroy() them before it goes.
+class FrameCache {
+public:
+  // Up to count width x height layers of format, fewer if that's over the driver's layer limit or it runs
+  // out of memory. makeSRGB (may be null) makes the sRGB view of a layer's view.
+  bool init(int width, int height, GLenum format, size_t count, GLuint (*makeSRGB)(GLuint));
+  void destroy();
+
+  // Layer holding frame, marked as just used. -1 if it isn't cached.
+  int find(size_t frame);
+  bool contains(size_t frame) const;
+  // Layer to detile frame into, taken from the least recently used frame
+  int insert(size_t frame);
+
+  size_t capacity() const {
+    return layers.size();
+  }
+  GLuint array() const {
+    return texture;
+  }
+  GLuint view(int layer) const {
+    return layers[layer].view;
+  }
+  GLuint srgbView(int layer) const {
+    return layers[layer].srgbView;
+  }
+
+private:
+  static constexpr size_t noFrame = SIZE_MAX;
+
+  struct Layer {
+    GLuint view = 0;
+    GLuint srgbView = 0;
+    size_t frame = noFrame;
+    std::list<int>::iterator use;
+  };
+
+  GLuint texture = 0;
+  std::vector<Layer> layers;
+  // Layers from most to least recently used
+  std::list<int> recent;
+  std::unordered_map<size_t, int> frameLayers;
+};
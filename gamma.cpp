@@ -0,0 +1,47 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "gamma.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+bool loadGammaPWL(const char* path, GammaLut& lut) {
+  std::ifstream f(path, std::ios::in | std::ios::binary);
+  uint8_t ramp[128][3][4];
+  if (!f || !f.read(reinterpret_cast<char*>(ramp), sizeof(ramp))) {
+    std::cout << "Failed to read gamma ramp " << path << "!" << std::endl;
+    return false;
+  }
+
+  for (uint32_t i = 0; i < 256; i++) {
+    // Same 8 -> 10 bit expansion the display controller does
+    const uint32_t value = (i << 2) | (i >> 6);
+    const uint32_t segment = value >> 3;
+    for (uint32_t c = 0; c < 3; c++) {
+      const uint32_t base = ramp[segment][c][0] << 8 | ramp[segment][c][1];
+      const uint32_t delta = ramp[segment][c][2] << 8 | ramp[segment][c][3];
+      lut.rgb[i][c] = static_cast<uint16_t>(std::min(base + ((delta * (value & 7)) >> 3), 0xFFFFu));
+    }
+  }
+  return true;
+}
+
+bool gammaPreset(const std::string& name, GammaLut& lut) {
+  for (uint32_t i = 0; i < 256; i++) {
+    const double x = i / 255.0;
+    double y;
+    if (name == "linear")
+      y = x;
+    else if (name == "2.2")
+      y = std::pow(x, 1.0 / 2.2);
+    else if (name == "srgb")
+      y = x <= 0.0031308 ? x * 12.92 : 1.055 * std::pow(x, 1.0 / 2.4) - 0.055;
+    else
+      return false;
+    const uint16_t v = static_cast<uint16_t>(std::lround(y * 65535.0));
+    lut.rgb[i][0] = lut.rgb[i][1] = lut.rgb[i][2] = v;
+  }
+  return true;
+}
@@ -0,0 +1,19 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// The console's PWL gamma ramp, evaluated for every 8 bit channel value.
+// Entries are 16 bit (full range) RGB, this is what the present pass samples.
+struct GammaLut {
+  uint16_t rgb[256][3];
+};
+
+// Loads a dumped PWL ramp: 128 segments, each with a {base, delta} pair per R/G/B channel,
+// stored as big endian 16 bit values (register order). Segments cover 8 steps of the 10 bit input.
+bool loadGammaPWL(const char* path, GammaLut& lut);
+
+// Built in ramps: "linear", "2.2" and "srgb"
+bool gammaPreset(const std::string& name, GammaLut& lut);
@@ -0,0 +1,82 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "hdr.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+struct Color {
+  float r, g, b, a;
+};
+
+static float halfToFloat(uint32_t h) {
+  const uint32_t sign = (h >> 15) & 1;
+  const uint32_t exponent = (h >> 10) & 31;
+  const uint32_t mantissa = h & 1023;
+  float value;
+  if (exponent == 0)
+    value = std::ldexp(static_cast<float>(mantissa), -24);
+  else if (exponent == 31)
+    value = mantissa ? NAN : INFINITY;
+  else
+    value = std::ldexp(static_cast<float>(mantissa | 1024), static_cast<int>(exponent) - 25);
+  return sign ? -value : value;
+}
+
+// 7e3: 3 bit exponent (bias 3), 7 bit mantissa, no sign
+static float f7e3ToFloat(uint32_t v) {
+  const uint32_t exponent = (v >> 7) & 7;
+  const uint32_t mantissa = v & 127;
+  if (exponent == 0)
+    return std::ldexp(static_cast<float>(mantissa), -9);
+  return std::ldexp(static_cast<float>(mantissa | 128), static_cast<int>(exponent) - 10);
+}
+
+static Color loadTexel(const uint8_t* src, uint32_t x, uint32_t y, uint32_t width, SurfaceFormat format) {
+  const uint32_t size = bytesPerBlock(format);
+  const uint32_t offset = xeTiledOffset2D(x, y, width, size == 8 ? 3 : 2);
+  uint32_t words[2];
+  std::memcpy(words, src + static_cast<uint64_t>(offset) * size, size);
+  if (format == SurfaceFormat::k_16_16_16_16_FLOAT)
+    return {halfToFloat(words[0] & 0xFFFF), halfToFloat(words[0] >> 16), halfToFloat(words[1] & 0xFFFF),
+            halfToFloat(words[1] >> 16)};
+  return {f7e3ToFloat(words[0]), f7e3ToFloat(words[0] >> 10), f7e3ToFloat(words[0] >> 20), (words[0] >> 30) / 3.0f};
+}
+
+static float luminance(const Color& c) {
+  return 0.2126f * c.r + 0.7152f * c.g + 0.0722f * c.b;
+}
+
+static float tonemap(float v, Tonemap op) {
+  v = std::max(v, 0.0f);
+  if (op == Tonemap::Reinhard)
+    return v / (1.0f + v);
+  // Narkowicz ACES fit
+  return std::clamp((v * (2.51f * v + 0.03f)) / (v * (2.43f * v + 0.59f) + 0.14f), 0.0f, 1.0f);
+}
+
+static uint32_t encodeSRGB(float v) {
+  v = v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+  return static_cast<uint32_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f));
+}
+
+void detileTonemap(const uint8_t* src, uint32_t* dst, uint32_t width, uint32_t height, SurfaceFormat format,
+                   Tonemap op) {
+  const uint32_t tiledWidth = TILE(width);
+  double logSum = 0.0;
+  for (uint32_t y = 0; y < height; y++) {
+    for (uint32_t x = 0; x < width; x++)
+      logSum += std::log2(std::max(luminance(loadTexel(src, x, y, tiledWidth, format)), 1e-4f));
+  }
+  const float exposure = tonemapKey / static_cast<float>(std::exp2(logSum / (static_cast<double>(width) * height)));
+
+  for (uint32_t y = 0; y < height; y++) {
+    for (uint32_t x = 0; x < width; x++) {
+      const Color c = loadTexel(src, x, y, tiledWidth, format);
+      const uint32_t a = static_cast<uint32_t>(std::lround(std::clamp(c.a, 0.0f, 1.0f) * 255.0f));
+      dst[y * width + x] = a << 24 | encodeSRGB(tonemap(c.r * exposure, op)) << 16 |
+                           encodeSRGB(tonemap(c.g * exposure, op)) << 8 | encodeSRGB(tonemap(c.b * exposure, op));
+    }
+  }
+}
@@ -0,0 +1,20 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+
+#include "xenos.h"
+
+enum class Tonemap : uint8_t {
+  Reinhard,
+  ACES,
+};
+
+// Key value the average luminance gets mapped to
+constexpr float tonemapKey = 0.18f;
+
+// Detiles a float render target and tonemaps it to width * height ARGB pixels.
+// Exposure comes from the average log luminance of the whole surface, same as the GPU path.
+void detileTonemap(const uint8_t* src, uint32_t* dst, uint32_t width, uint32_t height, SurfaceFormat format,
+                   Tonemap op);
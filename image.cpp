@@ -0,0 +1,164 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "image.h"
+#include "gamma.h"
+#include "png.h"
+#include "qoi.h"
+
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <string_view>
+
+ImageFormat imageFormatFromPath(const char* path) {
+  const std::string_view name = path;
+  if (name.ends_with(".png"))
+    return ImageFormat::PNG;
+  if (name.ends_with(".qoi"))
+    return ImageFormat::QOI;
+  if (name.ends_with(".ppm"))
+    return ImageFormat::PPM;
+  if (name.ends_with(".raw"))
+    return ImageFormat::Raw;
+  return ImageFormat::PAM;
+}
+
+bool parseImageFormat(const std::string& name, ImageFormat& format) {
+  for (const ImageFormat candidate :
+       {ImageFormat::PAM, ImageFormat::PNG, ImageFormat::QOI, ImageFormat::PPM, ImageFormat::Raw}) {
+    if (name == imageExtension(candidate) + 1) {
+      format = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* imageExtension(ImageFormat format) {
+  switch (format) {
+  case ImageFormat::PNG:
+    return ".png";
+  case ImageFormat::QOI:
+    return ".qoi";
+  case ImageFormat::PPM:
+    return ".ppm";
+  case ImageFormat::Raw:
+    return ".raw";
+  default:
+    return ".pam";
+  }
+}
+
+bool hasFixedRows(ImageFormat format) {
+  return format == ImageFormat::PAM || format == ImageFormat::PPM || format == ImageFormat::Raw;
+}
+
+uint32_t bytesPerPixel(ImageFormat format) {
+  return format == ImageFormat::PPM ? 3 : 4;
+}
+
+std::string imageHeader(ImageFormat format, uint32_t width, uint32_t height) {
+  switch (format) {
+  case ImageFormat::PAM:
+    return "P7\nWIDTH " + std::to_string(width) + "\nHEIGHT " + std::to_string(height) +
+           "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+  case ImageFormat::PPM:
+    return "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+  default:
+    return {};
+  }
+}
+
+void convertRow(ImageFormat format, const uint32_t* src, uint8_t* dst, uint32_t width, const GammaLut* gamma) {
+  if (format == ImageFormat::Raw) {
+    std::memcpy(dst, src, static_cast<size_t>(width) * 4);
+    if (gamma) {
+      // BGRA bytes
+      for (uint32_t x = 0; x < width; x++) {
+        for (uint32_t c = 0; c < 3; c++)
+          dst[x * 4 + c] = gamma->rgb[dst[x * 4 + c]][2 - c] >> 8;
+      }
+    }
+    return;
+  }
+  const uint32_t bpp = bytesPerPixel(format);
+  for (uint32_t x = 0; x < width; x++) {
+    uint8_t* out = dst + x * bpp;
+    out[0] = (src[x] >> 16) & 0xFF;
+    out[1] = (src[x] >> 8) & 0xFF;
+    out[2] = (src[x] >> 0) & 0xFF;
+    if (bpp == 4)
+      out[3] = (src[x] >> 24) & 0xFF;
+    if (gamma) {
+      for (uint32_t c = 0; c < 3; c++)
+        out[c] = gamma->rgb[out[c]][c] >> 8;
+    }
+  }
+}
+
+ImageWriter::ImageWriter(const char* path, uint32_t width, uint32_t height, const GammaLut* gamma)
+    : file(path, std::ios::out | std::ios::binary), out(file), format(imageFormatFromPath(path)), width(width),
+      gamma(gamma) {
+  if (!file) {
+    std::cout << "Failed to open " << path << " for writing!" << std::endl;
+    return;
+  }
+  writeHeader(height);
+}
+
+ImageWriter::ImageWriter(std::ostream& out, ImageFormat format, uint32_t width, uint32_t height,
+                         const GammaLut* gamma)
+    : out(out), format(format), width(width), gamma(gamma) {
+  if (out)
+    writeHeader(height);
+}
+
+void ImageWriter::writeHeader(uint32_t height) {
+  switch (format) {
+  case ImageFormat::PNG:
+    png = std::make_unique<PngEncoder>(out, width, height);
+    break;
+  case ImageFormat::QOI:
+    qoi = std::make_unique<QoiEncoder>(out, width, height);
+    break;
+  default:
+    out << imageHeader(format, width, height);
+    break;
+  }
+}
+
+ImageWriter::~ImageWriter() = default;
+
+bool ImageWriter::writeRows(const uint32_t* pixels, uint32_t count, uint32_t stride) {
+  const size_t rowSize = static_cast<size_t>(width) * bytesPerPixel(format);
+  converted.resize(rowSize * count);
+  for (uint32_t y = 0; y < count; y++)
+    convertRow(format, pixels + static_cast<uint64_t>(y) * stride, converted.data() + y * rowSize, width, gamma);
+  switch (format) {
+  case ImageFormat::PNG:
+    png->writeRows(converted.data(), count);
+    break;
+  case ImageFormat::QOI:
+    qoi->writeRows(converted.data(), count);
+    break;
+  default:
+    out.write(reinterpret_cast<const char*>(converted.data()), static_cast<std::streamsize>(converted.size()));
+    break;
+  }
+  return out.good();
+}
+
+bool ImageWriter::finish() {
+  if (png)
+    png->finish();
+  if (qoi)
+    qoi->finish();
+  out.flush();
+  return out.good();
+}
+
+bool writeImage(const char* path, const uint32_t* pixels, uint32_t width, uint32_t height, const GammaLut* gamma,
+                uint32_t stride) {
+  ImageWriter writer(path, width, height, gamma);
+  return writer && writer.writeRows(pixels, height, stride ? stride : width) && writer.finish();
+}
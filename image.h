@@ -0,0 +1,71 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct GammaLut;
+class PngEncoder;
+class QoiEncoder;
+
+// Output image formats, picked from the file extension (.png, .qoi, .ppm, .raw, anything else is PAM)
+enum class ImageFormat : uint8_t {
+  PAM,
+  PNG,
+  QOI,
+  PPM, // RGB, alpha is dropped
+  Raw, // No header, ARGB words as the detiler writes them (BGRA bytes)
+};
+
+ImageFormat imageFormatFromPath(const char* path);
+// By name (pam, png, qoi, ppm, raw), false if unknown
+bool parseImageFormat(const std::string& name, ImageFormat& format);
+// With the dot, ".png"
+const char* imageExtension(ImageFormat format);
+
+// PAM, PPM and raw images are a fixed header and fixed size rows, so they can be written into a
+// mapped file. These describe that layout.
+bool hasFixedRows(ImageFormat format);
+uint32_t bytesPerPixel(ImageFormat format);
+std::string imageHeader(ImageFormat format, uint32_t width, uint32_t height);
+// One row of ARGB pixels to the format's bytes (RGBA for PAM/PNG/QOI), applying the gamma ramp if any
+void convertRow(ImageFormat format, const uint32_t* src, uint8_t* dst, uint32_t width, const GammaLut* gamma);
+
+// Writes width * height ARGB pixels as an image, a batch of rows at a time, so the linear image
+// never has to exist in full. The gamma ramp, if any, is applied while converting each row.
+class ImageWriter {
+public:
+  ImageWriter(const char* path, uint32_t width, uint32_t height, const GammaLut* gamma = nullptr);
+  // Into a stream the caller owns, e.g. a DirectFile
+  ImageWriter(std::ostream& out, ImageFormat format, uint32_t width, uint32_t height,
+              const GammaLut* gamma = nullptr);
+  ~ImageWriter();
+
+  explicit operator bool() const {
+    return out.good();
+  }
+
+  // count rows, stride pixels apart. All height rows have to be written before finish().
+  bool writeRows(const uint32_t* pixels, uint32_t count, uint32_t stride);
+  bool finish();
+
+private:
+  void writeHeader(uint32_t height);
+
+  std::ofstream file; // Only when opened by path
+  std::ostream& out;
+  ImageFormat format;
+  uint32_t width;
+  const GammaLut* gamma;
+  std::vector<uint8_t> converted; // The batch
+  std::unique_ptr<PngEncoder> png;
+  std::unique_ptr<QoiEncoder> qoi;
+};
+
+// Whole image in one go. stride is the distance between rows in pixels, 0 for tightly packed rows.
+bool writeImage(const char* path, const uint32_t* pixels, uint32_t width, uint32_t height,
+                const GammaLut* gamma = nullptr, uint32_t stride = 0);
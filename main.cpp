@@ -2,27 +2,115 @@
 
 #include <SDL3/SDL.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include "batch_output.h"
+#include "bc.h"
+#include "bc_encode.h"
+#include "detile.h"
+#include "frame_cache.h"
+#include "gamma.h"
+#include "hdr.h"
+#include "image.h"
+#include "mapped_file.h"
+#include "region.h"
+#include "scaler.h"
+#include "shader_variants.h"
+#include "surface_view.h"
+#include "xenos.h"
+
 #define GL_GLEXT_PROTOTYPES
 extern "C" {
 #include <KHR/khrplatform.h>
 #include <glad/glad.h>
 }
 
-#define TILE(x) ((((x) + 31) >> 5) << 5)
+int internalWidth = 1280;
+int internalHeight = 720;
+int resWidth = TILE(internalWidth);
+int resHeight = TILE(internalHeight);
+// Initial window size, the scaler output size if there's one
+int windowWidth = resWidth;
+int windowHeight = resHeight;
+
+// Where the image lands in the window. Resizing only moves this, nothing upstream of present reruns.
+struct Rect {
+  int x, y, w, h;
+};
+Rect presentRect;
+int drawableWidth, drawableHeight;
+bool integerScale = false;
+
+// The tiled source changed, detile (and scale) again on the next frame
+bool surfaceDirty = true;
+// The present filter needs to run again (new source or new present size)
+bool upscaleDirty = true;
 
-constexpr int resWidth = TILE(1280);
-constexpr int resHeight = TILE(720);
-constexpr int internalWidth = 1280;
-constexpr int internalHeight = 720;
+SurfaceFormat surfaceFormat = SurfaceFormat::k_8_8_8_8;
+// Textures are stored 8in16 swapped
+bool endianSwap = true;
 
 SDL_Window* window;
 SDL_GLContext context;
-GLuint texture, shaderProgram, pixelBuffer;
+GLuint texture, bcShaderProgram, pixelBuffer;
+// What the passes after detiling read: texture, or a frame cache layer in the timeline viewer
+GLuint detiledTexture, detiledTextureSRGB;
+
+// Which compute kernel detiles the 8888 framebuffer, KERNEL in detileComputeShaderSource
+enum class DetileKernel : uint8_t {
+  PerPixel, // One invocation per pixel
+  Walker,   // One invocation per tile row run
+  Shuffle,  // A workgroup per tile row pair, needs GL_KHR_shader_subgroup
+};
+DetileKernel detileKernel = DetileKernel::PerPixel;
+// Where those kernels read the tiled dump from, INPUT in detileComputeShaderSource
+enum class DetileInput : uint8_t {
+  SSBO,          // pixel_data[] in pixelBuffer
+  TextureBuffer, // usamplerBuffer over pixelBuffer, the same memory through the texture cache
+  Texture2D,     // tiledTexture, each tile's 1024 words as a 32x32 texel block in the tile's own place
+};
+DetileInput detileInput = DetileInput::SSBO;
+ShaderVariants shaderVariants;
+// The variant detileKernel and detileInput pick, resolved once by initShaders
+GLuint detileShaderProgram;
+GLuint tiledBufferTexture, tiledTexture;
 GLuint dummyVAO, renderShaderProgram;
+GLuint gammaTexture;
+// Float render targets detile into hdrTexture, exposure lives in luminanceBuffer
+GLuint hdrTexture, hdrShaderProgram, exposureShaderProgram, tonemapShaderProgram, luminanceBuffer;
+Tonemap tonemapOperator = Tonemap::Reinhard;
+// Display scaler, horizontal pass into intermediateTexture then vertical into scaledTexture
+bool scalerEnabled = false;
+ScalerConfig scalerConfig;
+GLuint scalerHShaderProgram, scalerVShaderProgram, intermediateTexture, scaledTexture;
+GLuint scalerCoefficients[2];
+// Present filter, upscales to the window in two passes through upscaleIntermediateTexture
+PresentFilter presentFilter = PresentFilter::Nearest;
+GLuint upscaleHShaderProgram, upscaleVShaderProgram, upscaleIntermediateTexture, upscaledTexture;
+int upscaleWidth, upscaleHeight;
+
+// sRGB views of the ARGB targets, sampled with hardware decode/filtering and presented to an sRGB framebuffer
+bool srgbOutput = false;
+GLuint textureSRGB, scaledTextureSRGB, upscaledTextureSRGB, srgbShaderProgram;
+
+// PWL gamma ramp applied on present, loaded from --gamma
+bool gammaEnabled = false;
+GammaLut gammaLut;
 
 int initSDL(const char* windowName, const int w, const int h, SDL_WindowFlags flags) {
   if (!SDL_Init(SDL_INIT_VIDEO)) {
@@ -45,11 +133,15 @@ constexpr const char* vertexShaderSource = R"(
 
 out vec2 o_texture_coord;
 
+// Crops the tile padding off the bottom/right of the texture
+uniform vec2 u_uvScale;
+
 // https://www.gamedev.net/forums/topic/609917-full-screen-quad-without-vertex-buffer/
 // HOWEVER, the OpenGL spec needs a VAO still. This means we can get away with using less data at least
 void main() {
-  o_texture_coord = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
-  gl_Position = vec4(o_texture_coord * vec2(2.0f, -2.0f) + vec2(-1.0f, 1.0f), 0.0f, 1.0f);
+  vec2 uv = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+  gl_Position = vec4(uv * vec2(2.0f, -2.0f) + vec2(-1.0f, 1.0f), 0.0f, 1.0f);
+  o_texture_coord = uv * u_uvScale;
 })";
 
 constexpr const char* fragmentShaderSource = R"(
@@ -60,6 +152,9 @@ in vec2 o_texture_coord;
 out vec4 o_color;
 
 uniform usampler2D u_texture;
+// Gamma ramp, 256 entries indexed by the 8 bit channel value
+uniform sampler1D u_gamma;
+uniform bool u_gammaEnabled;
 void main() {
   uint pixel = texture(u_texture, o_texture_coord).r;
   // Gotta love BE vs LE (X360 works in BGRA, so we work in ARGB)
@@ -67,25 +162,79 @@ void main() {
   float r = float((pixel >> 16) & 0xFF) / 255.0;
   float g = float((pixel >> 8) & 0xFF) / 255.0;
   float b = float((pixel >> 0) & 0xFF) / 255.0;
+  if (u_gammaEnabled) {
+    r = texelFetch(u_gamma, int((pixel >> 16) & 0xFF), 0).r;
+    g = texelFetch(u_gamma, int((pixel >> 8) & 0xFF), 0).g;
+    b = texelFetch(u_gamma, int((pixel >> 0) & 0xFF), 0).b;
+  }
   o_color = vec4(r, g, b, a);
 })";
 
-constexpr const char* computeShaderSource = R"(
+// All the 8888 kernels in one source, ShaderVariants builds the one detileProgram asks for:
+//   KERNEL      0 per pixel, 1 walker, 2 shuffle (DetileKernel)
+//   INPUT       0 SSBO, 1 texture buffer, 2 2D texture (DetileInput)
+//   BATCH       1 for --gpu-batch (SSBO input only): frame z of the SSBO goes to layer z of an array
+//   RES_WIDTH, RES_HEIGHT, INTERNAL_WIDTH, INTERNAL_HEIGHT
+// The sizes are baked in, so every address is constant folded and the per pixel kernel only keeps its
+// resampling when the texture isn't the tiled size.
+constexpr const char* detileComputeShaderSource = R"(
 #version 430 core
+#if KERNEL == 2
+#extension GL_KHR_shader_subgroup_basic : require
+#extension GL_KHR_shader_subgroup_shuffle : require
+#endif
 
-layout (local_size_x = 16, local_size_y = 16) in;
+// storeDetiled(pos, pixel) writes a pixel of the detiled frame
+#if BATCH
+layout (r32ui, binding = 7) uniform writeonly uimage2DArray o_frames;
 
+void storeDetiled(ivec2 pos, uint pixel) {
+  imageStore(o_frames, ivec3(pos, gl_GlobalInvocationID.z), uvec4(pixel, 0, 0, 0));
+}
+#else
 layout (r32ui, binding = 0) uniform writeonly uimage2D o_texture;
+
+void storeDetiled(ivec2 pos, uint pixel) {
+  imageStore(o_texture, pos, uvec4(pixel, 0, 0, 0));
+}
+#endif
+
+// fetchTiled(i) is word i of the dump. Texture inputs sit on unit 2, the present pass has 0 and 1.
+#if INPUT == 0
 layout (std430, binding = 1) buffer pixel_buffer
 {
   uint pixel_data[];
 };
 
-uniform int internalWidth;
-uniform int internalHeight;
+uint fetchTiled(int index) {
+#if BATCH
+  // The frames are back to back
+  return pixel_data[gl_GlobalInvocationID.z * uint(RES_WIDTH * RES_HEIGHT) + uint(index)];
+#else
+  return pixel_data[index];
+#endif
+}
+#elif INPUT == 1
+layout (binding = 2) uniform usamplerBuffer u_tiled;
+
+uint fetchTiled(int index) {
+  return texelFetch(u_tiled, index).r;
+}
+#else
+layout (binding = 2) uniform usampler2D u_tiled;
+
+#define TILES_X (RES_WIDTH / 32)
+
+uint fetchTiled(int index) {
+  int tile = index >> 10;
+  ivec2 pos = ivec2((tile % TILES_X) * 32 + (index & 31), (tile / TILES_X) * 32 + ((index >> 5) & 31));
+  return texelFetch(u_tiled, pos, 0).r;
+}
+#endif
 
-uniform int resWidth;
-uniform int resHeight;
+#if KERNEL == 0
+// One invocation per pixel
+layout (local_size_x = 16, local_size_y = 16) in;
 
 // This is black magic to convert tiles to linear, just don't touch it
 int xeFbConvert(int width, int addr) {
@@ -98,207 +247,2464 @@ int xeFbConvert(int width, int addr) {
 
 #define TILE(x) ((x + 31) >> 5) << 5
 
+// Precalc whatever it would be with extra sizing for 32x32 tiles
+#define TILED_WIDTH (TILE(INTERNAL_WIDTH))
+#define TILED_HEIGHT (TILE(INTERNAL_HEIGHT))
+
 void main() {
   ivec2 texel_pos = ivec2(gl_GlobalInvocationID.xy);
   // OOB check, but shouldn't be needed
-  if (texel_pos.x >= resWidth || texel_pos.y >= resHeight)
+  if (texel_pos.x >= RES_WIDTH || texel_pos.y >= RES_HEIGHT)
     return;
 
-  // Precalc whatever it would be with extra sizing for 32x32 tiles
-  const int tiledWidth = TILE(internalWidth);
-  const int tiledHeight = TILE(internalHeight);
-
+#if RES_WIDTH != TILED_WIDTH || RES_HEIGHT != TILED_HEIGHT
   // Scale accordingly
-  const float scaleX = tiledWidth / float(resWidth);
-  const float scaleY = tiledHeight / float(resHeight);
+  const float scaleX = TILED_WIDTH / float(RES_WIDTH);
+  const float scaleY = TILED_HEIGHT / float(RES_HEIGHT);
 
   // Map to source resolution
   int srcX = int(float(texel_pos.x) * scaleX);
   int srcY = int(float(texel_pos.y) * scaleY);
+#else
+  int srcX = texel_pos.x;
+  int srcY = texel_pos.y;
+#endif
 
   // God only knows how this indexing works
-  int stdIndex = (srcY * tiledWidth + srcX);
-  int xeIndex = xeFbConvert(tiledWidth, stdIndex * 4);
+  int stdIndex = (srcY * TILED_WIDTH + srcX);
+  int xeIndex = xeFbConvert(TILED_WIDTH, stdIndex * 4);
 
-  uint packedColor = pixel_data[xeIndex];
-  imageStore(o_texture, texel_pos, uvec4(packedColor, 0, 0, 0));
-})";
+  uint packedColor = fetchTiled(xeIndex);
+  storeDetiled(texel_pos, packedColor);
+}
+#elif KERNEL == 1
+// Each invocation detiles a 32 pixel run (one tile row) of a scanline. The tiled address is worked out
+// once per run and then carried along pixel by pixel, no integer division at all.
+layout (local_size_x = 8, local_size_y = 8) in;
 
-void compileShader(GLuint shader, const char* source) {
-  glShaderSource(shader, 1, &source, nullptr);
-  glCompileShader(shader);
+#define RUN_LENGTH 32u
 
-  int success;
-  char infoLog[512];
-  glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-  if (!success) {
-    glGetShaderInfoLog(shader, 512, NULL, infoLog);
-    std::cout << "Shader Compilation Error:\n" << infoLog << std::endl;
+void main() {
+  uint x0 = gl_GlobalInvocationID.x * RUN_LENGTH;
+  uint y = gl_GlobalInvocationID.y;
+  if (x0 >= uint(RES_WIDTH) || y >= uint(RES_HEIGHT))
+    return;
+
+  // Rows with y & 8 have the 16 pixel halves of the tile row swapped
+  int flip = (y & 8u) != 0u ? 4 : 0;
+  int addr = int((y & ~31u) * uint(RES_WIDTH) + ((y & 1u) << 2) + ((y & 30u) << 5) + (x0 >> 5) * 1024u) + flip * 8;
+  for (uint i = 0u; i < RUN_LENGTH; i++) {
+    storeDetiled(ivec2(x0 + i, y), fetchTiled(addr));
+    // Carry from x & 3 into the next 4 pixel group, runs never cross a tile
+    int group = int(i >> 2);
+    if ((i & 3u) != 3u)
+      addr += 1;
+    else
+      addr += (((group + 1) ^ flip) - (group ^ flip)) * 8 - 3;
   }
 }
+#else
+// One workgroup per row pair of a tile. The pair's 64 words are loaded in order, one per invocation, and
+// subgroupShuffle hands each invocation the word of the pixel it stores, no shared memory round trip.
+// Word bits 0-1 are x & 3, bit 2 is y & 1 and bits 3-5 are x >> 2 (flipped by y & 8), so a subgroup of
+// S >= 8 invocations owning S aligned words holds S / 2 whole consecutive pixels of both rows.
+layout (local_size_x = 64) in;
 
-GLuint createShaderProgram(const char* vertex, const char* fragment) {
-  GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-  compileShader(vertexShader, vertex);
-  GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-  compileShader(fragmentShader, fragment);
-  GLuint program = glCreateProgram();
-  glAttachShader(program, vertexShader);
-  glAttachShader(program, fragmentShader);
-  glLinkProgram(program);
-  glDeleteShader(vertexShader);
-  glDeleteShader(fragmentShader);
-  return program;
+void main() {
+  uint tileX = gl_WorkGroupID.x;
+  uint y0 = gl_WorkGroupID.y * 2u;
+  uint flip = (y0 & 8u) != 0u ? 32u : 0u;
+  // Words are handed out by subgroup, not by local index, so each subgroup owns an aligned run of them
+  uint size = gl_SubgroupSize;
+  uint lane = gl_SubgroupInvocationID;
+  uint first = gl_SubgroupID * size;
+  uint word = fetchTiled(int((y0 & ~31u) * uint(RES_WIDTH) + tileX * 1024u + ((y0 & 30u) << 5) + first + lane));
+
+  // This subgroup's pixels are span of them on each row, starting at the x of its first word
+  uint span = size >> 1;
+  uint x = ((((first ^ flip) >> 3) << 2) & ~(span - 1u)) + (lane & (span - 1u));
+  uint row = lane / span;
+  uint source = (((x & 3u) | (row << 2) | ((x >> 2) << 3)) ^ flip) - first;
+  uint pixel = subgroupShuffle(word, source);
+  storeDetiled(ivec2(tileX * 32u + x, y0 + row), pixel);
 }
+#endif
+)";
 
-void initShaders() {
-  GLuint computeShader = glCreateShader(GL_COMPUTE_SHADER);
-  compileShader(computeShader, computeShaderSource);
-  shaderProgram = glCreateProgram();
-  glAttachShader(shaderProgram, computeShader);
-  glLinkProgram(shaderProgram);
-  glDeleteShader(computeShader);
-  renderShaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+// Fused detile + BCn decode, one invocation per 4x4 block
+constexpr const char* bcComputeShaderSource = R"(
+#version 430 core
+
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (r32ui, binding = 0) uniform writeonly uimage2D o_texture;
+layout (std430, binding = 1) buffer pixel_buffer
+{
+  uint pixel_data[];
+};
+
+uniform int internalWidth;
+uniform int internalHeight;
+
+#define FORMAT_DXT1 0
+#define FORMAT_DXT2_3 1
+#define FORMAT_DXT4_5 2
+#define FORMAT_DXN 3
+uniform int blockFormat;
+uniform bool endianSwap;
+
+// XGAddress2DTiledOffset, in blocks
+uint xeTiledOffset2D(uint x, uint y, uint width, uint logBpb) {
+  uint alignedWidth = (width + 31u) & ~31u;
+  uint macro = ((x >> 5) + (y >> 5) * (alignedWidth >> 5)) << (logBpb + 7u);
+  uint micro = ((x & 7u) + ((y & 6u) << 2)) << logBpb;
+  uint offset = macro + ((micro & ~15u) << 1) + (micro & 15u) + ((y & 8u) << (3u + logBpb)) + ((y & 1u) << 4);
+  return ((((offset & ~511u) << 3) + ((offset & 448u) << 2) + (offset & 63u)) +
+         ((y & 16u) << 7) + (((((y & 8u) >> 2) + (x >> 3)) & 3u) << 6)) >> logBpb;
 }
 
-void initTexture() {
-  glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
-  glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, resWidth, resHeight);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-  glBindImageTexture(0, texture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
-  glBindBuffer(GL_TEXTURE_2D, 0);
+uint loadWord(uint index) {
+  uint word = pixel_data[index];
+  return endianSwap ? ((word & 0x00FF00FFu) << 8) | ((word >> 8) & 0x00FF00FFu) : word;
 }
 
-// ARGB (Console is BGRA)
-#define COLOR(r, g, b, a) ((a) << 24 | (r) << 16 | (g) << 8 | (b) << 0)
+uint expand565(uint c) {
+  uint r = (c >> 11) & 31u;
+  uint g = (c >> 5) & 63u;
+  uint b = c & 31u;
+  return 0xFF000000u | ((r << 3 | r >> 2) << 16) | ((g << 2 | g >> 4) << 8) | (b << 3 | b >> 2);
+}
 
-constexpr int pitch = resWidth * resHeight * sizeof(const uint32_t);
-const std::vector<uint32_t> pixels(pitch, COLOR(30, 30, 30, 255)); // Init with dark grey
+uint lerpColor(uint a, uint b, uint wa, uint wb, uint div) {
+  uvec3 ca = (uvec3(a) >> uvec3(16, 8, 0)) & 0xFFu;
+  uvec3 cb = (uvec3(b) >> uvec3(16, 8, 0)) & 0xFFu;
+  uvec3 c = (ca * wa + cb * wb) / div;
+  return 0xFF000000u | (c.r << 16) | (c.g << 8) | c.b;
+}
 
-void initPixelBuffer() {
-  glGenBuffers(1, &pixelBuffer);
-  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, pixelBuffer);
-  glBufferData(GL_SHADER_STORAGE_BUFFER, pixels.size(), pixels.data(), GL_DYNAMIC_DRAW);
-  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+void colorPalette(uint word, bool bc1, out uint pal[4]) {
+  uint c0 = word & 0xFFFFu;
+  uint c1 = word >> 16;
+  pal[0] = expand565(c0);
+  pal[1] = expand565(c1);
+  if (!bc1 || c0 > c1) {
+    pal[2] = lerpColor(pal[0], pal[1], 2u, 1u, 3u);
+    pal[3] = lerpColor(pal[0], pal[1], 1u, 2u, 3u);
+  } else {
+    pal[2] = lerpColor(pal[0], pal[1], 1u, 1u, 2u);
+    pal[3] = 0u;
+  }
 }
 
-void computeDispatch() {
-  glUseProgram(shaderProgram);
-  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, pixelBuffer);
-  glUniform1i(glGetUniformLocation(shaderProgram, "internalWidth"), internalWidth);
-  glUniform1i(glGetUniformLocation(shaderProgram, "internalHeight"), internalHeight);
-  glUniform1i(glGetUniformLocation(shaderProgram, "resWidth"), resWidth);
-  glUniform1i(glGetUniformLocation(shaderProgram, "resHeight"), resHeight);
-  glDispatchCompute(resWidth / 16, resHeight / 16, 1);
-  glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+void channelPalette(uint word, out uint pal[8]) {
+  uint a0 = word & 0xFFu;
+  uint a1 = (word >> 8) & 0xFFu;
+  pal[0] = a0;
+  pal[1] = a1;
+  if (a0 > a1) {
+    for (uint i = 1u; i < 7u; i++)
+      pal[i + 1u] = ((7u - i) * a0 + i * a1) / 7u;
+  } else {
+    for (uint i = 1u; i < 5u; i++)
+      pal[i + 1u] = ((5u - i) * a0 + i * a1) / 5u;
+    pal[6] = 0u;
+    pal[7] = 255u;
+  }
 }
 
-void initOpenGL() {
-  SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
-  SDL_GL_SetAttribute(SDL_GL_ACCELERATED_VISUAL, 1);
-  SDL_GL_SetAttribute(SDL_GL_RED_SIZE, 8);
-  SDL_GL_SetAttribute(SDL_GL_GREEN_SIZE, 8);
-  SDL_GL_SetAttribute(SDL_GL_BLUE_SIZE, 8);
-  SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 8);
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+// 3 bit index i out of the 48 bits following the endpoints
+uint channelIndex(uint w0, uint w1, uint i) {
+  uint lo = (w0 >> 16) | (w1 << 16);
+  uint hi = w1 >> 16;
+  uint off = i * 3u;
+  if (off >= 32u)
+    return (hi >> (off - 32u)) & 7u;
+  uint v = lo >> off;
+  if (off > 29u)
+    v |= hi << (32u - off);
+  return v & 7u;
+}
 
-  context = SDL_GL_CreateContext(window);
+void main() {
+  uvec2 block = gl_GlobalInvocationID.xy;
+  uint blocksX = (uint(internalWidth) + 3u) / 4u;
+  uint blocksY = (uint(internalHeight) + 3u) / 4u;
+  if (block.x >= blocksX || block.y >= blocksY)
+    return;
 
-  if (!context) {
-    SDL_Log("Failed to create OpenGL context: %s", SDL_GetError());
-    exit(-1);
+  // Read the block straight from its tiled location
+  uint logBpb = blockFormat == FORMAT_DXT1 ? 3u : 4u;
+  uint base = xeTiledOffset2D(block.x, block.y, blocksX, logBpb) << (logBpb - 2u);
+  uint w0 = loadWord(base);
+  uint w1 = loadWord(base + 1u);
+  uint w2 = 0u, w3 = 0u;
+  if (blockFormat != FORMAT_DXT1) {
+    w2 = loadWord(base + 2u);
+    w3 = loadWord(base + 3u);
   }
 
-  if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) {
-    SDL_Log("Failed to initialize GLAD");
-    exit(-1);
+  uint color[4];
+  uint alpha[8];
+  uint green[8];
+  if (blockFormat == FORMAT_DXT1)
+    colorPalette(w0, true, color);
+  else if (blockFormat != FORMAT_DXN)
+    colorPalette(w2, false, color);
+  if (blockFormat == FORMAT_DXT4_5 || blockFormat == FORMAT_DXN)
+    channelPalette(w0, alpha);
+  if (blockFormat == FORMAT_DXN)
+    channelPalette(w2, green);
+
+  for (uint i = 0u; i < 16u; i++) {
+    ivec2 texel_pos = ivec2(block * 4u + uvec2(i & 3u, i >> 2));
+    if (texel_pos.x >= internalWidth || texel_pos.y >= internalHeight)
+      continue;
+    uint packedColor;
+    if (blockFormat == FORMAT_DXT1) {
+      packedColor = color[(w1 >> (i * 2u)) & 3u];
+    } else if (blockFormat == FORMAT_DXT2_3) {
+      uint a = ((i < 8u ? w0 >> (i * 4u) : w1 >> ((i - 8u) * 4u)) & 15u) * 17u;
+      packedColor = (color[(w3 >> (i * 2u)) & 3u] & 0x00FFFFFFu) | (a << 24);
+    } else if (blockFormat == FORMAT_DXT4_5) {
+      packedColor = (color[(w3 >> (i * 2u)) & 3u] & 0x00FFFFFFu) | (alpha[channelIndex(w0, w1, i)] << 24);
+    } else {
+      packedColor = 0xFF000000u | (alpha[channelIndex(w0, w1, i)] << 16) | (green[channelIndex(w2, w3, i)] << 8);
+    }
+    imageStore(o_texture, texel_pos, uvec4(packedColor, 0, 0, 0));
   }
+})";
 
-  initShaders();
-  initTexture();
-  initPixelBuffer();
-  // Creat a dummy VAO
-  glGenVertexArrays(1, &dummyVAO);
-  // Setup viewport
-  glViewport(0, 0, resWidth, resHeight);
-  glDisable(GL_BLEND);
-  glDisable(GL_DEPTH_TEST);
+// BC1/BC7 encoder for the timeline's compressed frame cache, one invocation per block of the detiled texture.
+// Same algorithm and integer math as encodeBlocks (bc_encode.h), a block comes out identical either way.
+// ShaderVariants defines BC7 (0 for BC1) and BLOCKS_X, BLOCKS_Y.
+constexpr const char* bcEncodeComputeShaderSource = R"(
+#version 430 core
 
-  glClearColor(0.7f, 0.7f, 0.7f, 1.f);
+layout (local_size_x = 8, local_size_y = 8) in;
 
-  SDL_GL_SetSwapInterval(0);
-  SDL_SetWindowFullscreen(window, false);
-}
+layout (r32ui, binding = 0) uniform readonly uimage2D i_texture;
+layout (std430, binding = 6) writeonly buffer block_buffer
+{
+  uint block_data[];
+};
 
-void passPixelBuffer(uint32_t* data, size_t size) {
-  glBindBuffer(GL_SHADER_STORAGE_BUFFER, pixelBuffer);
-  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, pitch, data);
-  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+uvec4 unpackRGBA(uint pixel) {
+  return (uvec4(pixel) >> uvec4(16, 8, 0, 24)) & 0xFFu;
 }
 
-const std::unique_ptr<uint8_t[]> buffer = std::make_unique<uint8_t[]>(pitch * 4);
+// Squared distance, dot() is float only
+uint distance2(ivec4 d) {
+  d *= d;
+  return uint(d.x + d.y + d.z + d.w);
+}
 
-void render() {
-  // Send over the buffer with the 360fb that is swizzled
-  passPixelBuffer(reinterpret_cast<uint32_t*>(buffer.get()), pitch);
+#if BC7
+const uint weights[16] = uint[](0u, 4u, 9u, 13u, 17u, 21u, 26u, 30u, 34u, 38u, 43u, 47u, 51u, 55u, 60u, 64u);
 
-  // Dispatch compute shader to unswizzle data
-  computeDispatch();
+// 7 bit endpoint and p-bit closest to an RGBA endpoint
+void quantizeEndpoint(uvec4 target, out uvec4 v7, out uint pbit) {
+  uint bestError = 0xFFFFFFFFu;
+  for (uint p = 0u; p < 2u; p++) {
+    uvec4 v = min((target - p + 1u) >> 1, uvec4(127u));
+    uint error = distance2(ivec4(v << 1 | p) - ivec4(target));
+    if (error < bestError) {
+      bestError = error;
+      pbit = p;
+      v7 = v;
+    }
+  }
+}
 
-  // Stop anything from updating texture after finishing CS
-  glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+uint bits[4];
+uint position;
 
-  // Draw fullscreen rect
-  glUseProgram(renderShaderProgram);
-  glBindTexture(GL_TEXTURE_2D, texture);
-  glBindVertexArray(dummyVAO);
-  glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+void putBits(uint value, uint count) {
+  for (uint i = 0u; i < count; i++, position++)
+    bits[position >> 5] |= ((value >> i) & 1u) << (position & 31u);
+}
+#else
+uint expand565(uint c) {
+  uint r = (c >> 11) & 31u;
+  uint g = (c >> 5) & 63u;
+  uint b = c & 31u;
+  return 0xFF000000u | ((r << 3 | r >> 2) << 16) | ((g << 2 | g >> 4) << 8) | (b << 3 | b >> 2);
+}
 
-  // Swap
-  SDL_GL_SwapWindow(window);
+uint lerpColor(uint a, uint b, uint wa, uint wb, uint div) {
+  uvec3 ca = (uvec3(a) >> uvec3(16, 8, 0)) & 0xFFu;
+  uvec3 cb = (uvec3(b) >> uvec3(16, 8, 0)) & 0xFFu;
+  uvec3 c = (ca * wa + cb * wb) / div;
+  return 0xFF000000u | (c.r << 16) | (c.g << 8) | c.b;
 }
 
-void shutdownRender() {
-  glDeleteProgram(shaderProgram);
-  SDL_GL_DestroyContext(context);
-  SDL_DestroyWindow(window);
+uint pack565(uvec3 c) {
+  uvec3 q = (c * uvec3(31u, 63u, 31u) + 127u) / 255u;
+  return q.r << 11 | q.g << 5 | q.b;
 }
+#endif
 
-int main() {
-  std::cout << "Width: " << resWidth << std::endl;
-  std::cout << "Height: " << resHeight << std::endl;
-  SDL_WindowFlags flags = SDL_WINDOW_OPENGL;
-  if (initSDL("Xenon FB Conversion", resWidth, resHeight, flags) != 0) {
-    return 1;
+void main() {
+  uvec2 block = gl_GlobalInvocationID.xy;
+  if (block.x >= uint(BLOCKS_X) || block.y >= uint(BLOCKS_Y))
+    return;
+  uvec4 texels[16];
+  uvec4 lo = uvec4(255u), hi = uvec4(0u);
+  for (int i = 0; i < 16; i++) {
+    texels[i] = unpackRGBA(imageLoad(i_texture, ivec2(block * 4u) + ivec2(i & 3, i >> 2)).r);
+    lo = min(lo, texels[i]);
+    hi = max(hi, texels[i]);
   }
+  uint index = block.y * uint(BLOCKS_X) + block.x;
 
-  std::ifstream f("fbmem.bin", std::ios::in | std::ios::binary);
+#if BC7
+  uvec4 e[2];
+  uint p[2];
+  quantizeEndpoint(lo, e[0], p[0]);
+  quantizeEndpoint(hi, e[1], p[1]);
+  uvec4 palette[16];
+  for (uint j = 0u; j < 16u; j++)
+    palette[j] = ((64u - weights[j]) * (e[0] << 1 | p[0]) + weights[j] * (e[1] << 1 | p[1]) + 32u) >> 6;
+  uint indices[16];
+  for (int i = 0; i < 16; i++) {
+    uint best = 0u;
+    uint bestError = distance2(ivec4(texels[i]) - ivec4(palette[0]));
+    for (uint j = 1u; j < 16u; j++) {
+      uint error = distance2(ivec4(texels[i]) - ivec4(palette[j]));
+      if (error < bestError) {
+        best = j;
+        bestError = error;
+      }
+    }
+    indices[i] = best;
+  }
+  // The first index only has 3 bits, swapping the endpoints mirrors the weights
+  if ((indices[0] & 8u) != 0u) {
+    uvec4 te = e[0];
+    e[0] = e[1];
+    e[1] = te;
+    uint tp = p[0];
+    p[0] = p[1];
+    p[1] = tp;
+    for (int i = 0; i < 16; i++)
+      indices[i] = 15u - indices[i];
+  }
 
-  if (!f) {
-    std::cout << "Failed to open framebuffer dump!" << std::endl;
-  } else {
-    f.read(reinterpret_cast<char*>(buffer.get()), pitch * 4);
+  bits = uint[](0u, 0u, 0u, 0u);
+  position = 0u;
+  putBits(1u << 6, 7u); // Mode 6
+  for (int c = 0; c < 4; c++) {
+    putBits(e[0][c], 7u);
+    putBits(e[1][c], 7u);
+  }
+  putBits(p[0], 1u);
+  putBits(p[1], 1u);
+  putBits(indices[0], 3u);
+  for (int i = 1; i < 16; i++)
+    putBits(indices[i], 4u);
+  for (uint w = 0u; w < 4u; w++)
+    block_data[index * 4u + w] = bits[w];
+#else
+  // Quantizing keeps the order, so c0 >= c1 and the block is in 4 color mode unless they're equal
+  uint c0 = pack565(hi.rgb);
+  uint c1 = pack565(lo.rgb);
+  uint indices = 0u;
+  if (c0 != c1) {
+    uint p0 = expand565(c0);
+    uint p1 = expand565(c1);
+    uvec4 palette[4] = uvec4[](unpackRGBA(p0), unpackRGBA(p1), unpackRGBA(lerpColor(p0, p1, 2u, 1u, 3u)),
+                               unpackRGBA(lerpColor(p0, p1, 1u, 2u, 3u)));
+    for (int i = 0; i < 16; i++) {
+      uint best = 0u;
+      uint bestError = distance2(ivec4(ivec3(texels[i].rgb) - ivec3(palette[0].rgb), 0));
+      for (uint j = 1u; j < 4u; j++) {
+        uint error = distance2(ivec4(ivec3(texels[i].rgb) - ivec3(palette[j].rgb), 0));
+        if (error < bestError) {
+          best = j;
+          bestError = error;
+        }
+      }
+      indices |= best << (i * 2);
+    }
   }
-  f.close();
+  block_data[index * 2u] = c0 | c1 << 16;
+  block_data[index * 2u + 1u] = indices;
+#endif
+}
+)";
 
-  initOpenGL();
+// Float render targets: detile + decode into an RGBA16F image, and reduce log luminance per workgroup
+constexpr const char* hdrComputeShaderSource = R"(
+#version 430 core
 
-  bool running = true;
-  SDL_Event event;
-  while (running) {
-    while (SDL_PollEvent(&event)) {
-      if (event.type == SDL_EVENT_QUIT)
-        running = false;
+layout (local_size_x = 16, local_size_y = 16) in;
+
+layout (rgba16f, binding = 2) uniform writeonly image2D o_hdr;
+layout (std430, binding = 1) buffer pixel_buffer
+{
+  uint pixel_data[];
+};
+layout (std430, binding = 3) buffer luminance_buffer
+{
+  float exposure;
+  float exposureTarget;
+  vec2 partials[]; // Sum of log2 luminance and texel count, per workgroup
+};
+
+uniform int internalWidth;
+uniform int internalHeight;
+uniform bool isHalf;
+
+shared vec2 s_logLum[256];
+
+// XGAddress2DTiledOffset, in texels
+uint xeTiledOffset2D(uint x, uint y, uint width, uint logBpb) {
+  uint alignedWidth = (width + 31u) & ~31u;
+  uint macro = ((x >> 5) + (y >> 5) * (alignedWidth >> 5)) << (logBpb + 7u);
+  uint micro = ((x & 7u) + ((y & 6u) << 2)) << logBpb;
+  uint offset = macro + ((micro & ~15u) << 1) + (micro & 15u) + ((y & 8u) << (3u + logBpb)) + ((y & 1u) << 4);
+  return ((((offset & ~511u) << 3) + ((offset & 448u) << 2) + (offset & 63u)) +
+         ((y & 16u) << 7) + (((((y & 8u) >> 2) + (x >> 3)) & 3u) << 6)) >> logBpb;
+}
+
+// 7e3: 3 bit exponent (bias 3), 7 bit mantissa
+float f7e3(uint v) {
+  uint e = (v >> 7) & 7u;
+  float m = float(v & 127u);
+  return e == 0u ? m * exp2(-9.0) : (m + 128.0) * exp2(float(e) - 10.0);
+}
+
+void main() {
+  ivec2 texel_pos = ivec2(gl_GlobalInvocationID.xy);
+  float logLum = 0.0;
+  float count = 0.0;
+  if (texel_pos.x < internalWidth && texel_pos.y < internalHeight) {
+    uint tiledWidth = (uint(internalWidth) + 31u) & ~31u;
+    vec4 color;
+    if (isHalf) {
+      uint index = xeTiledOffset2D(uint(texel_pos.x), uint(texel_pos.y), tiledWidth, 3u) * 2u;
+      color = vec4(unpackHalf2x16(pixel_data[index]), unpackHalf2x16(pixel_data[index + 1u]));
+    } else {
+      uint word = pixel_data[xeTiledOffset2D(uint(texel_pos.x), uint(texel_pos.y), tiledWidth, 2u)];
+      color = vec4(f7e3(word), f7e3(word >> 10), f7e3(word >> 20), float(word >> 30) / 3.0);
     }
-    render();
+    imageStore(o_hdr, texel_pos, color);
+    logLum = log2(max(dot(color.rgb, vec3(0.2126, 0.7152, 0.0722)), 1e-4));
+    count = 1.0;
+  }
+
+  // Tree reduction in shared memory, one partial per workgroup
+  uint lid = gl_LocalInvocationIndex;
+  s_logLum[lid] = vec2(logLum, count);
+  barrier();
+  for (uint stride = 128u; stride > 0u; stride >>= 1) {
+    if (lid < stride)
+      s_logLum[lid] += s_logLum[lid + stride];
+    barrier();
+  }
+  if (lid == 0u)
+    partials[gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x] = s_logLum[0];
+}
+)";
+
+// Second pass of the reduction, one workgroup folds every partial into the exposure
+constexpr const char* exposureShaderSource = R"(
+#version 430 core
+
+layout (local_size_x = 256) in;
+
+layout (std430, binding = 3) buffer luminance_buffer
+{
+  float exposure;
+  float exposureTarget;
+  vec2 partials[];
+};
+
+uniform int partialCount;
+uniform float key;
+// How far to move towards the target exposure per frame, 1 snaps to it
+uniform float adaptation;
+
+shared vec2 s_logLum[256];
+
+void main() {
+  uint lid = gl_LocalInvocationIndex;
+  vec2 sum = vec2(0.0);
+  for (int i = int(lid); i < partialCount; i += 256)
+    sum += partials[i];
+  s_logLum[lid] = sum;
+  barrier();
+  for (uint stride = 128u; stride > 0u; stride >>= 1) {
+    if (lid < stride)
+      s_logLum[lid] += s_logLum[lid + stride];
+    barrier();
+  }
+  if (lid == 0u) {
+    exposureTarget = key / exp2(s_logLum[0].x / max(s_logLum[0].y, 1.0));
+    exposure = exposure > 0.0 ? mix(exposure, exposureTarget, adaptation) : exposureTarget;
+  }
+}
+)";
+
+constexpr const char* tonemapFragmentShaderSource = R"(
+#version 430 core
+
+in vec2 o_texture_coord;
+
+out vec4 o_color;
+
+layout (std430, binding = 3) readonly buffer luminance_buffer
+{
+  float exposure;
+};
+
+uniform sampler2D u_hdr;
+#define TONEMAP_REINHARD 0
+#define TONEMAP_ACES 1
+uniform int u_tonemap;
+
+vec3 aces(vec3 x) {
+  // Narkowicz fit
+  return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+}
+
+vec3 encodeSRGB(vec3 c) {
+  return mix(c * 12.92, 1.055 * pow(c, vec3(1.0 / 2.4)) - 0.055, step(vec3(0.0031308), c));
+}
+
+// The framebuffer does the encode when it's sRGB
+uniform bool u_hardwareSRGB;
+
+void main() {
+  vec4 color = texture(u_hdr, o_texture_coord);
+  vec3 c = max(color.rgb * exposure, vec3(0.0));
+  c = u_tonemap == TONEMAP_ACES ? aces(c) : c / (1.0 + c);
+  o_color = vec4(u_hardwareSRGB ? c : encodeSRGB(c), color.a);
+})";
+
+// sRGB present, decode + filtering happen in the sampler and the encode on framebuffer write
+constexpr const char* srgbFragmentShaderSource = R"(
+#version 430 core
+
+in vec2 o_texture_coord;
+
+out vec4 o_color;
+
+uniform sampler2D u_texture;
+void main() {
+  o_color = texture(u_texture, o_texture_coord);
+})";
+
+// Polyphase scaler, horizontal pass. Reads the detiled texture, writes filtered RGBA16F.
+constexpr const char* scalerHComputeShaderSource = R"(
+#version 430 core
+
+layout (local_size_x = 16, local_size_y = 16) in;
+
+layout (rgba16f, binding = 3) uniform writeonly image2D o_intermediate;
+layout (std430, binding = 4) readonly buffer coefficient_buffer
+{
+  float coefficients[]; // phases * taps
+};
+
+uniform usampler2D u_source;
+uniform int srcSize;
+uniform int dstSize;
+uniform int taps;
+uniform int phases;
+uniform ivec2 outputSize;
+
+vec4 unpackARGB(uint pixel) {
+  return vec4((uvec4(pixel) >> uvec4(16, 8, 0, 24)) & 0xFFu) / 255.0;
+}
+
+void main() {
+  ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+  if (pos.x >= outputSize.x || pos.y >= outputSize.y)
+    return;
+
+  // Pick the phase closest to where the output texel lands in the source
+  float srcPos = (float(pos.x) + 0.5) * float(srcSize) / float(dstSize) - 0.5;
+  float base = floor(srcPos);
+  int phase = int((srcPos - base) * float(phases) + 0.5);
+  int first = int(base) - (taps / 2 - 1);
+  if (phase == phases) {
+    phase = 0;
+    first++;
   }
 
+  vec4 sum = vec4(0.0);
+  for (int t = 0; t < taps; t++) {
+    int x = clamp(first + t, 0, srcSize - 1);
+    sum += coefficients[phase * taps + t] * unpackARGB(texelFetch(u_source, ivec2(x, pos.y), 0).r);
+  }
+  imageStore(o_intermediate, pos, sum);
+})";
+
+// Polyphase scaler, vertical pass. Packs back to ARGB so the present pass doesn't change.
+constexpr const char* scalerVComputeShaderSource = R"(
+#version 430 core
+
+layout (local_size_x = 16, local_size_y = 16) in;
+
+layout (r32ui, binding = 4) uniform writeonly uimage2D o_scaled;
+layout (std430, binding = 5) readonly buffer coefficient_buffer
+{
+  float coefficients[]; // phases * taps
+};
+
+uniform sampler2D u_intermediate;
+uniform int srcSize;
+uniform int dstSize;
+uniform int taps;
+uniform int phases;
+uniform ivec2 outputSize;
+
+uint packARGB(vec4 color) {
+  uvec4 c = uvec4(round(clamp(color, 0.0, 1.0) * 255.0));
+  return (c.a << 24) | (c.r << 16) | (c.g << 8) | c.b;
+}
+
+void main() {
+  ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+  if (pos.x >= outputSize.x || pos.y >= outputSize.y)
+    return;
+
+  float srcPos = (float(pos.y) + 0.5) * float(srcSize) / float(dstSize) - 0.5;
+  float base = floor(srcPos);
+  int phase = int((srcPos - base) * float(phases) + 0.5);
+  int first = int(base) - (taps / 2 - 1);
+  if (phase == phases) {
+    phase = 0;
+    first++;
+  }
+
+  vec4 sum = vec4(0.0);
+  for (int t = 0; t < taps; t++) {
+    int y = clamp(first + t, 0, srcSize - 1);
+    sum += coefficients[phase * taps + t] * texelFetch(u_intermediate, ivec2(pos.x, y), 0);
+  }
+  imageStore(o_scaled, pos, uvec4(packARGB(sum), 0, 0, 0));
+})";
+
+// Separable Lanczos-3 / bicubic upscale, horizontal pass.
+// Each workgroup caches the source span its 16x16 outputs need (plus apron) in shared memory,
+// so every source texel is fetched once per workgroup instead of once per tap.
+constexpr const char* upscaleHComputeShaderSource = R"(
+#version 430 core
+
+layout (local_size_x = 16, local_size_y = 16) in;
+
+layout (rgba16f, binding = 5) uniform writeonly image2D o_intermediate;
+
+uniform usampler2D u_source;
+uniform ivec2 srcSize;
+uniform ivec2 dstSize;
+
+#define FILTER_BICUBIC 1
+#define FILTER_LANCZOS3 2
+uniform int filterMode;
+
+// Enough for 16 outputs + apron up to 2.5x downscaling, past that we fall back to texelFetch
+#define SPAN 48
+shared vec4 s_tile[16][SPAN];
+
+vec4 unpackARGB(uint pixel) {
+  return vec4((uvec4(pixel) >> uvec4(16, 8, 0, 24)) & 0xFFu) / 255.0;
+}
+
+float sinc(float x) {
+  x *= 3.14159265;
+  return x == 0.0 ? 1.0 : sin(x) / x;
+}
+
+float weight(float x) {
+  x = abs(x);
+  if (filterMode == FILTER_LANCZOS3)
+    return x < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+  // Catmull-Rom
+  if (x < 1.0)
+    return 1.5 * x * x * x - 2.5 * x * x + 1.0;
+  return x < 2.0 ? -0.5 * x * x * x + 2.5 * x * x - 4.0 * x + 2.0 : 0.0;
+}
+
+void main() {
+  ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+  float scale = float(srcSize.x) / float(dstSize.x);
+  int spanStart = int(floor((float(gl_WorkGroupID.x * 16u) + 0.5) * scale - 0.5)) - 2;
+
+  for (uint i = gl_LocalInvocationIndex; i < 16u * SPAN; i += 256u) {
+    int row = min(int(gl_WorkGroupID.y * 16u + i / SPAN), srcSize.y - 1);
+    int x = clamp(spanStart + int(i % SPAN), 0, srcSize.x - 1);
+    s_tile[i / SPAN][i % SPAN] = unpackARGB(texelFetch(u_source, ivec2(x, row), 0).r);
+  }
+  barrier();
+
+  if (pos.x >= dstSize.x || pos.y >= srcSize.y)
+    return;
+
+  float srcPos = (float(pos.x) + 0.5) * scale - 0.5;
+  int base = int(floor(srcPos));
+  float frac = srcPos - float(base);
+  int radius = filterMode == FILTER_LANCZOS3 ? 3 : 2;
+  vec4 sum = vec4(0.0);
+  float weightSum = 0.0;
+  for (int t = 1 - radius; t <= radius; t++) {
+    float w = weight(float(t) - frac);
+    int c = base + t - spanStart;
+    vec4 texel = c >= 0 && c < SPAN ? s_tile[gl_LocalInvocationID.y][c]
+                                    : unpackARGB(texelFetch(u_source, ivec2(clamp(base + t, 0, srcSize.x - 1), pos.y), 0).r);
+    sum += w * texel;
+    weightSum += w;
+  }
+  imageStore(o_intermediate, pos, sum / weightSum);
+})";
+
+// Vertical pass, same caching along columns. Packs back to ARGB for the present pass.
+constexpr const char* upscaleVComputeShaderSource = R"(
+#version 430 core
+
+layout (local_size_x = 16, local_size_y = 16) in;
+
+layout (r32ui, binding = 6) uniform writeonly uimage2D o_upscaled;
+
+uniform sampler2D u_intermediate;
+uniform ivec2 srcSize; // Intermediate is dstSize.x * srcSize.y
+uniform ivec2 dstSize;
+
+#define FILTER_BICUBIC 1
+#define FILTER_LANCZOS3 2
+uniform int filterMode;
+
+#define SPAN 48
+shared vec4 s_tile[SPAN][16];
+
+uint packARGB(vec4 color) {
+  uvec4 c = uvec4(round(clamp(color, 0.0, 1.0) * 255.0));
+  return (c.a << 24) | (c.r << 16) | (c.g << 8) | c.b;
+}
+
+float sinc(float x) {
+  x *= 3.14159265;
+  return x == 0.0 ? 1.0 : sin(x) / x;
+}
+
+float weight(float x) {
+  x = abs(x);
+  if (filterMode == FILTER_LANCZOS3)
+    return x < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+  if (x < 1.0)
+    return 1.5 * x * x * x - 2.5 * x * x + 1.0;
+  return x < 2.0 ? -0.5 * x * x * x + 2.5 * x * x - 4.0 * x + 2.0 : 0.0;
+}
+
+void main() {
+  ivec2 pos = ivec2(gl_GlobalInvocationID.xy);
+  float scale = float(srcSize.y) / float(dstSize.y);
+  int spanStart = int(floor((float(gl_WorkGroupID.y * 16u) + 0.5) * scale - 0.5)) - 2;
+
+  for (uint i = gl_LocalInvocationIndex; i < 16u * SPAN; i += 256u) {
+    int column = min(int(gl_WorkGroupID.x * 16u + i % 16u), dstSize.x - 1);
+    int y = clamp(spanStart + int(i / 16u), 0, srcSize.y - 1);
+    s_tile[i / 16u][i % 16u] = texelFetch(u_intermediate, ivec2(column, y), 0);
+  }
+  barrier();
+
+  if (pos.x >= dstSize.x || pos.y >= dstSize.y)
+    return;
+
+  float srcPos = (float(pos.y) + 0.5) * scale - 0.5;
+  int base = int(floor(srcPos));
+  float frac = srcPos - float(base);
+  int radius = filterMode == FILTER_LANCZOS3 ? 3 : 2;
+  vec4 sum = vec4(0.0);
+  float weightSum = 0.0;
+  for (int t = 1 - radius; t <= radius; t++) {
+    float w = weight(float(t) - frac);
+    int r = base + t - spanStart;
+    vec4 texel = r >= 0 && r < SPAN ? s_tile[r][gl_LocalInvocationID.x]
+                                    : texelFetch(u_intermediate, ivec2(pos.x, clamp(base + t, 0, srcSize.y - 1)), 0);
+    sum += w * texel;
+    weightSum += w;
+  }
+  imageStore(o_upscaled, pos, uvec4(packARGB(sum / weightSum), 0, 0, 0));
+})";
+
+void compileShader(GLuint shader, const char* source) {
+  glShaderSource(shader, 1, &source, nullptr);
+  glCompileShader(shader);
+
+  int success;
+  char infoLog[512];
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+  if (!success) {
+    glGetShaderInfoLog(shader, 512, NULL, infoLog);
+    std::cout << "Shader Compilation Error:\n" << infoLog << std::endl;
+  }
+}
+
+GLuint createShaderProgram(const char* vertex, const char* fragment) {
+  GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+  compileShader(vertexShader, vertex);
+  GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+  compileShader(fragmentShader, fragment);
+  GLuint program = glCreateProgram();
+  glAttachShader(program, vertexShader);
+  glAttachShader(program, fragmentShader);
+  glLinkProgram(program);
+  glDeleteShader(vertexShader);
+  glDeleteShader(fragmentShader);
+  return program;
+}
+
+GLuint createComputeProgram(const char* source) {
+  GLuint computeShader = glCreateShader(GL_COMPUTE_SHADER);
+  compileShader(computeShader, source);
+  GLuint program = glCreateProgram();
+  glAttachShader(program, computeShader);
+  glLinkProgram(program);
+  glDeleteShader(computeShader);
+  return program;
+}
+
+bool extensionSupported(const char* name) {
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; i++) {
+    if (std::strcmp(reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)), name) == 0)
+      return true;
+  }
+  return false;
+}
+
+// GL_KHR_shader_subgroup isn't in glad's core 4.3 profile
+#define GL_SUBGROUP_SIZE_KHR 0x9532
+#define GL_SUBGROUP_SUPPORTED_STAGES_KHR 0x9533
+#define GL_SUBGROUP_SUPPORTED_FEATURES_KHR 0x9534
+#define GL_SUBGROUP_FEATURE_BASIC_BIT_KHR 0x00000001
+#define GL_SUBGROUP_FEATURE_SHUFFLE_BIT_KHR 0x00000010
+
+// The shuffle kernel wants subgroup shuffles in compute shaders, and subgroups of 8 to 64 invocations so
+// a subgroup covers whole 4 pixel groups and fits in the 64 invocation workgroup
+bool subgroupShuffleSupported() {
+  if (!extensionSupported("GL_KHR_shader_subgroup"))
+    return false;
+  GLint size = 0, stages = 0, features = 0;
+  glGetIntegerv(GL_SUBGROUP_SIZE_KHR, &size);
+  glGetIntegerv(GL_SUBGROUP_SUPPORTED_STAGES_KHR, &stages);
+  glGetIntegerv(GL_SUBGROUP_SUPPORTED_FEATURES_KHR, &features);
+  const GLint needed = GL_SUBGROUP_FEATURE_BASIC_BIT_KHR | GL_SUBGROUP_FEATURE_SHUFFLE_BIT_KHR;
+  return (stages & GL_COMPUTE_SHADER_BIT) && (features & needed) == needed && size >= 8 && size <= 64 &&
+         (size & (size - 1)) == 0;
+}
+
+// The 8888 kernel reading from input, specialized for the current surface. Built on first use and
+// cached from then on. 0 if it doesn't build.
+GLuint detileProgram(DetileKernel kernel, DetileInput input, bool batch = false) {
+  const std::string defines = "#define KERNEL " + std::to_string(static_cast<int>(kernel)) +
+                              "\n#define INPUT " + std::to_string(static_cast<int>(input)) +
+                              "\n#define BATCH " + std::to_string(batch ? 1 : 0) +
+                              "\n#define RES_WIDTH " + std::to_string(resWidth) +
+                              "\n#define RES_HEIGHT " + std::to_string(resHeight) +
+                              "\n#define INTERNAL_WIDTH " + std::to_string(internalWidth) +
+                              "\n#define INTERNAL_HEIGHT " + std::to_string(internalHeight) + "\n";
+  return shaderVariants.get(detileComputeShaderSource, defines);
+}
+
+void initShaders() {
+  // Built up front so the first frame doesn't stall on it
+  detileShaderProgram = detileProgram(detileKernel, detileInput);
+  if (!detileShaderProgram && detileKernel == DetileKernel::Shuffle) {
+    std::cout << "The shuffle kernel doesn't build, using the walker kernel" << std::endl;
+    detileKernel = DetileKernel::Walker;
+    detileShaderProgram = detileProgram(detileKernel, detileInput);
+  }
+  bcShaderProgram = createComputeProgram(bcComputeShaderSource);
+  renderShaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+  hdrShaderProgram = createComputeProgram(hdrComputeShaderSource);
+  exposureShaderProgram = createComputeProgram(exposureShaderSource);
+  tonemapShaderProgram = createShaderProgram(vertexShaderSource, tonemapFragmentShaderSource);
+  if (presentFilter != PresentFilter::Nearest && !isHDR(surfaceFormat)) {
+    upscaleHShaderProgram = createComputeProgram(upscaleHComputeShaderSource);
+    upscaleVShaderProgram = createComputeProgram(upscaleVComputeShaderSource);
+  }
+  srgbShaderProgram = createShaderProgram(vertexShaderSource, srgbFragmentShaderSource);
+}
+
+// SRGB8_ALPHA8 view over an R32UI target, same storage, nothing gets copied.
+// The compute passes keep writing ARGB words through the R32UI side.
+GLuint createSRGBView(GLuint source) {
+  GLuint view;
+  glGenTextures(1, &view);
+  glTextureView(view, GL_TEXTURE_2D, source, GL_SRGB8_ALPHA8, 0, 1, 0, 1);
+  glBindTexture(GL_TEXTURE_2D, view);
+  // ARGB words are BGRA bytes
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  return view;
+}
+
+void initTexture() {
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, resWidth, resHeight);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindImageTexture(0, texture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+  glBindBuffer(GL_TEXTURE_2D, 0);
+  if (srgbOutput)
+    textureSRGB = createSRGBView(texture);
+  detiledTexture = texture;
+  detiledTextureSRGB = textureSRGB;
+}
+
+void initGammaTexture() {
+  glGenTextures(1, &gammaTexture);
+  glBindTexture(GL_TEXTURE_1D, gammaTexture);
+  glTexStorage1D(GL_TEXTURE_1D, 1, GL_RGB16, 256);
+  glTexSubImage1D(GL_TEXTURE_1D, 0, 0, 256, GL_RGB, GL_UNSIGNED_SHORT, gammaLut.rgb);
+  glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glBindTexture(GL_TEXTURE_1D, 0);
+
+  glUseProgram(renderShaderProgram);
+  glUniform1i(glGetUniformLocation(renderShaderProgram, "u_texture"), 0);
+  glUniform1i(glGetUniformLocation(renderShaderProgram, "u_gamma"), 1);
+  glUniform1i(glGetUniformLocation(renderShaderProgram, "u_gammaEnabled"), gammaEnabled);
+}
+
+int hdrGroupsX() {
+  return (internalWidth + 15) / 16;
+}
+
+int hdrGroupsY() {
+  return (internalHeight + 15) / 16;
+}
+
+void initHDR() {
+  glGenTextures(1, &hdrTexture);
+  glBindTexture(GL_TEXTURE_2D, hdrTexture);
+  glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, resWidth, resHeight);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindImageTexture(2, hdrTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  // exposure + exposureTarget, then a vec2 per workgroup. Zeroed exposure makes the first frame snap.
+  const std::vector<float> zero(2 + hdrGroupsX() * hdrGroupsY() * 2, 0.0f);
+  glGenBuffers(1, &luminanceBuffer);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, luminanceBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, zero.size() * sizeof(float), zero.data(), GL_DYNAMIC_COPY);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  glUseProgram(tonemapShaderProgram);
+  glUniform1i(glGetUniformLocation(tonemapShaderProgram, "u_hdr"), 0);
+  glUniform1i(glGetUniformLocation(tonemapShaderProgram, "u_tonemap"), static_cast<int>(tonemapOperator));
+}
+
+// ARGB (Console is BGRA)
+#define COLOR(r, g, b, a) ((a) << 24 | (r) << 16 | (g) << 8 | (b) << 0)
+
+// Size of the tiled dump in bytes
+size_t pitch = 0;
+
+void initPixelBuffer() {
+  const std::vector<uint32_t> pixels(pitch / 4, COLOR(30, 30, 30, 255)); // Init with dark grey
+  glGenBuffers(1, &pixelBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, pixelBuffer);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, pitch, pixels.data(), GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// Texture side of the detile inputs. The buffer texture is a view of pixelBuffer, the 2D texture a copy
+// made by uploadTiledTexture. False if the surface is too big for a buffer texture.
+bool initTiledInput(DetileInput input) {
+  if (input == DetileInput::TextureBuffer && !tiledBufferTexture) {
+    GLint maxTexels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    if (pitch / 4 > static_cast<size_t>(maxTexels)) {
+      std::cout << "Surface is over the " << maxTexels << " texel buffer texture limit" << std::endl;
+      return false;
+    }
+    glGenTextures(1, &tiledBufferTexture);
+    glBindTexture(GL_TEXTURE_BUFFER, tiledBufferTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, pixelBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+  }
+  if (input == DetileInput::Texture2D && !tiledTexture) {
+    glGenTextures(1, &tiledTexture);
+    glBindTexture(GL_TEXTURE_2D, tiledTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, resWidth, resHeight);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+  return true;
+}
+
+// Copies the tiles overlapping bytes [begin, end) of pixelBuffer into tiledTexture, GPU side. A tile is 1024
+// contiguous words, so each one is a single 32x32 unpack straight out of the buffer.
+void uploadTiledTexture(size_t begin, size_t end) {
+  const uint32_t tilesX = resWidth / 32;
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+  glBindTexture(GL_TEXTURE_2D, tiledTexture);
+  for (size_t tile = begin / 4096; tile < (end + 4095) / 4096; tile++)
+    glTexSubImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(tile % tilesX) * 32, static_cast<GLint>(tile / tilesX) * 32,
+                    32, 32, GL_RED_INTEGER, GL_UNSIGNED_INT, reinterpret_cast<const void*>(tile * 4096));
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void initScaler() {
+  if (!scalerEnabled)
+    return;
+
+  scalerHShaderProgram = createComputeProgram(scalerHComputeShaderSource);
+  scalerVShaderProgram = createComputeProgram(scalerVComputeShaderSource);
+  glGenTextures(1, &intermediateTexture);
+  glBindTexture(GL_TEXTURE_2D, intermediateTexture);
+  glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, scalerConfig.outputWidth, internalHeight);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glBindImageTexture(3, intermediateTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+  glGenTextures(1, &scaledTexture);
+  glBindTexture(GL_TEXTURE_2D, scaledTexture);
+  glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, scalerConfig.outputWidth, scalerConfig.outputHeight);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindImageTexture(4, scaledTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32UI);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  if (srgbOutput)
+    scaledTextureSRGB = createSRGBView(scaledTexture);
+
+  // Coefficient tables only depend on the mode, compute them once
+  const std::vector<float> coefficients[2] = {
+    polyphaseCoefficients(scalerConfig.taps, scalerConfig.phases, internalWidth, scalerConfig.outputWidth),
+    polyphaseCoefficients(scalerConfig.taps, scalerConfig.phases, internalHeight, scalerConfig.outputHeight),
+  };
+  glGenBuffers(2, scalerCoefficients);
+  for (int i = 0; i < 2; i++) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, scalerCoefficients[i]);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, coefficients[i].size() * sizeof(float), coefficients[i].data(),
+                 GL_STATIC_DRAW);
+  }
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void scalerPass(GLuint program, int srcSize, int dstSize, int outWidth, int outHeight) {
+  glUseProgram(program);
+  glUniform1i(glGetUniformLocation(program, "srcSize"), srcSize);
+  glUniform1i(glGetUniformLocation(program, "dstSize"), dstSize);
+  glUniform1i(glGetUniformLocation(program, "taps"), scalerConfig.taps);
+  glUniform1i(glGetUniformLocation(program, "phases"), scalerConfig.phases);
+  glUniform2i(glGetUniformLocation(program, "outputSize"), outWidth, outHeight);
+  glDispatchCompute((outWidth + 15) / 16, (outHeight + 15) / 16, 1);
+  glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+// Runs after detiling, source is the visible part of texture
+void scalerDispatch() {
+  const int outWidth = scalerConfig.outputWidth;
+  const int outHeight = scalerConfig.outputHeight;
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, scalerCoefficients[0]);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, scalerCoefficients[1]);
+
+  glBindTexture(GL_TEXTURE_2D, detiledTexture);
+  scalerPass(scalerHShaderProgram, internalWidth, outWidth, outWidth, internalHeight);
+  glBindTexture(GL_TEXTURE_2D, intermediateTexture);
+  scalerPass(scalerVShaderProgram, internalHeight, outHeight, outWidth, outHeight);
+}
+
+// Size of whatever the present pass would show, before the present filter
+void presentSourceSize(int& width, int& height) {
+  width = scalerEnabled ? scalerConfig.outputWidth : internalWidth;
+  height = scalerEnabled ? scalerConfig.outputHeight : internalHeight;
+}
+
+// (Re)allocates the upscaler targets for a new present size, the only thing a resize reallocates
+void resizeUpscaler(int width, int height) {
+  if (upscaledTexture) {
+    glDeleteTextures(1, &upscaleIntermediateTexture);
+    glDeleteTextures(1, &upscaledTexture);
+    if (srgbOutput)
+      glDeleteTextures(1, &upscaledTextureSRGB);
+  }
+  upscaleWidth = width;
+  upscaleHeight = height;
+  upscaleDirty = true;
+
+  int srcWidth, srcHeight;
+  presentSourceSize(srcWidth, srcHeight);
+  glGenTextures(1, &upscaleIntermediateTexture);
+  glBindTexture(GL_TEXTURE_2D, upscaleIntermediateTexture);
+  glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, upscaleWidth, srcHeight);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glBindImageTexture(5, upscaleIntermediateTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+  glGenTextures(1, &upscaledTexture);
+  glBindTexture(GL_TEXTURE_2D, upscaledTexture);
+  glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, upscaleWidth, upscaleHeight);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindImageTexture(6, upscaledTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32UI);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  if (srgbOutput)
+    upscaledTextureSRGB = createSRGBView(upscaledTexture);
+}
+
+void upscalePass(GLuint program, int srcWidth, int srcHeight, int outHeight) {
+  glUseProgram(program);
+  glUniform2i(glGetUniformLocation(program, "srcSize"), srcWidth, srcHeight);
+  glUniform2i(glGetUniformLocation(program, "dstSize"), upscaleWidth, upscaleHeight);
+  glUniform1i(glGetUniformLocation(program, "filterMode"), static_cast<int>(presentFilter));
+  glDispatchCompute((upscaleWidth + 15) / 16, (outHeight + 15) / 16, 1);
+  glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+// Filters source (the detiled or scaled texture) up to the present size
+void upscaleDispatch(GLuint source) {
+  int srcWidth, srcHeight;
+  presentSourceSize(srcWidth, srcHeight);
+  glBindTexture(GL_TEXTURE_2D, source);
+  upscalePass(upscaleHShaderProgram, srcWidth, srcHeight, srcHeight);
+  glBindTexture(GL_TEXTURE_2D, upscaleIntermediateTexture);
+  upscalePass(upscaleVShaderProgram, srcWidth, srcHeight, upscaleHeight);
+}
+
+// Fits the image into the window keeping its aspect ratio (letterboxed), optionally at integer scales only
+void updatePresentRect() {
+  SDL_GetWindowSizeInPixels(window, &drawableWidth, &drawableHeight);
+  int srcWidth, srcHeight;
+  presentSourceSize(srcWidth, srcHeight);
+
+  double scale = std::min(static_cast<double>(drawableWidth) / srcWidth, static_cast<double>(drawableHeight) / srcHeight);
+  if (integerScale && scale >= 1.0)
+    scale = std::floor(scale);
+  presentRect.w = std::max(1, static_cast<int>(srcWidth * scale));
+  presentRect.h = std::max(1, static_cast<int>(srcHeight * scale));
+  presentRect.x = (drawableWidth - presentRect.w) / 2;
+  presentRect.y = (drawableHeight - presentRect.h) / 2;
+
+  // The present filter is the one stage that has to follow the present size
+  if (presentFilter != PresentFilter::Nearest && !isHDR(surfaceFormat) &&
+      (presentRect.w != upscaleWidth || presentRect.h != upscaleHeight))
+    resizeUpscaler(presentRect.w, presentRect.h);
+}
+
+void computeDispatchBC() {
+  glUseProgram(bcShaderProgram);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, pixelBuffer);
+  glUniform1i(glGetUniformLocation(bcShaderProgram, "internalWidth"), internalWidth);
+  glUniform1i(glGetUniformLocation(bcShaderProgram, "internalHeight"), internalHeight);
+  glUniform1i(glGetUniformLocation(bcShaderProgram, "blockFormat"), static_cast<int>(surfaceFormat) - 1);
+  glUniform1i(glGetUniformLocation(bcShaderProgram, "endianSwap"), endianSwap);
+  const int blocksX = (internalWidth + 3) / 4;
+  const int blocksY = (internalHeight + 3) / 4;
+  glDispatchCompute((blocksX + 7) / 8, (blocksY + 7) / 8, 1);
+  glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+// Float render targets, decode + per workgroup log luminance. Exposure never leaves the GPU.
+void computeDispatchHDR() {
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, pixelBuffer);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, luminanceBuffer);
+
+  glUseProgram(hdrShaderProgram);
+  glUniform1i(glGetUniformLocation(hdrShaderProgram, "internalWidth"), internalWidth);
+  glUniform1i(glGetUniformLocation(hdrShaderProgram, "internalHeight"), internalHeight);
+  glUniform1i(glGetUniformLocation(hdrShaderProgram, "isHalf"), surfaceFormat == SurfaceFormat::k_16_16_16_16_FLOAT);
+  glDispatchCompute(hdrGroupsX(), hdrGroupsY(), 1);
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+// Runs every frame so the exposure keeps adapting, even when the surface didn't change
+void exposureDispatch() {
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, luminanceBuffer);
+  glUseProgram(exposureShaderProgram);
+  glUniform1i(glGetUniformLocation(exposureShaderProgram, "partialCount"), hdrGroupsX() * hdrGroupsY());
+  glUniform1f(glGetUniformLocation(exposureShaderProgram, "key"), tonemapKey);
+  glUniform1f(glGetUniformLocation(exposureShaderProgram, "adaptation"), 0.05f);
+  glDispatchCompute(1, 1, 1);
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+// 8888 framebuffer into texture with program, the variant of kernel reading from input
+void dispatchDetile(GLuint program, DetileKernel kernel, DetileInput input) {
+  glUseProgram(program);
+  switch (input) {
+  case DetileInput::SSBO:
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, pixelBuffer);
+    break;
+  case DetileInput::TextureBuffer:
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_BUFFER, tiledBufferTexture);
+    glActiveTexture(GL_TEXTURE0);
+    break;
+  case DetileInput::Texture2D:
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, tiledTexture);
+    glActiveTexture(GL_TEXTURE0);
+    break;
+  }
+  if (kernel == DetileKernel::Walker) {
+    glDispatchCompute((resWidth / 32 + 7) / 8, (resHeight + 7) / 8, 1);
+  } else if (kernel == DetileKernel::Shuffle) {
+    glDispatchCompute(resWidth / 32, resHeight / 2, 1);
+  } else {
+    glDispatchCompute(resWidth / 16, resHeight / 16, 1);
+  }
+  glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void computeDispatch() {
+  if (isBlockCompressed(surfaceFormat)) {
+    computeDispatchBC();
+    return;
+  }
+  if (isHDR(surfaceFormat)) {
+    computeDispatchHDR();
+    return;
+  }
+  dispatchDetile(detileShaderProgram, detileKernel, detileInput);
+}
+
+void initOpenGL() {
+  SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+  SDL_GL_SetAttribute(SDL_GL_ACCELERATED_VISUAL, 1);
+  SDL_GL_SetAttribute(SDL_GL_RED_SIZE, 8);
+  SDL_GL_SetAttribute(SDL_GL_GREEN_SIZE, 8);
+  SDL_GL_SetAttribute(SDL_GL_BLUE_SIZE, 8);
+  SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 8);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+  if (srgbOutput)
+    SDL_GL_SetAttribute(SDL_GL_FRAMEBUFFER_SRGB_CAPABLE, 1);
+
+  context = SDL_GL_CreateContext(window);
+
+  if (!context) {
+    SDL_Log("Failed to create OpenGL context: %s", SDL_GetError());
+    exit(-1);
+  }
+
+  if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) {
+    SDL_Log("Failed to initialize GLAD");
+    exit(-1);
+  }
+
+  // The input decides which 8888 kernels get built
+  initPixelBuffer();
+  if (!initTiledInput(detileInput))
+    detileInput = DetileInput::SSBO;
+  if (detileInput == DetileInput::Texture2D)
+    uploadTiledTexture(0, pitch);
+  if (detileKernel == DetileKernel::Shuffle && !subgroupShuffleSupported()) {
+    std::cout << "No GL_KHR_shader_subgroup shuffles, using the walker kernel" << std::endl;
+    detileKernel = DetileKernel::Walker;
+  }
+  initShaders();
+  initTexture();
+  initGammaTexture();
+  initHDR();
+  initScaler();
+  // Creat a dummy VAO
+  glGenVertexArrays(1, &dummyVAO);
+  // Setup viewport
+  updatePresentRect();
+  glDisable(GL_BLEND);
+  glDisable(GL_DEPTH_TEST);
+
+  glClearColor(0.7f, 0.7f, 0.7f, 1.f);
+
+  SDL_GL_SetSwapInterval(0);
+  SDL_SetWindowFullscreen(window, false);
+}
+
+std::unique_ptr<uint8_t[]> buffer;
+
+// Progressive load: the viewer reads the dump a tile row at a time on a loader thread, every finished
+// row is uploaded and detiled right away. Rows that haven't arrived yet keep the pixel buffer's dark grey.
+std::thread loaderThread;
+std::atomic<size_t> loadedBytes = 0;
+std::atomic<bool> stopLoading = false;
+// How much of loadedBytes is in pixelBuffer already
+size_t uploadedBytes = 0;
+
+void loadDump(std::ifstream file) {
+  const size_t rowSize = tiledRowSize(surfaceFormat, internalWidth);
+  for (size_t offset = 0; offset < pitch && !stopLoading; offset += rowSize) {
+    file.read(reinterpret_cast<char*>(buffer.get()) + offset, rowSize);
+    loadedBytes.store(offset + static_cast<size_t>(file.gcount()), std::memory_order_release);
+    if (!file) {
+      std::cout << "Framebuffer dump is shorter than the surface" << std::endl;
+      break;
+    }
+  }
+}
+
+// Send over what the loader has added to the swizzled 360fb since the last frame
+void passPixelBuffer() {
+  const size_t loaded = loadedBytes.load(std::memory_order_acquire);
+  if (loaded == uploadedBytes)
+    return;
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, pixelBuffer);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, uploadedBytes, loaded - uploadedBytes, buffer.get() + uploadedBytes);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  if (detileInput == DetileInput::Texture2D)
+    uploadTiledTexture(uploadedBytes, loaded);
+  uploadedBytes = loaded;
+  surfaceDirty = true;
+}
+
+// Timeline viewer: with several dumps the viewer steps through them as the frames of a capture (Left/Right,
+// held down to scrub). Detiled frames stay in frameCache, so going back over them is a texture bind. A reader
+// thread loads the dumps ahead in the scrub direction, and every frame drawn detiles one of those into the
+// cache, so by the time the scrub gets there they're cached too.
+std::vector<const char*> timelineDumps;
+size_t timelineFrame = 0;
+size_t shownFrame = SIZE_MAX;
+int timelineDirection = 1;
+size_t frameCacheBudget = static_cast<size_t>(512) << 20;
+FrameCache frameCache;
+// --frame-compression: layers hold BC1/BC7 blocks, 4-8x the frames in the same budget. Frames are encoded by
+// bcEncodeComputeShaderSource into blockBuffer and unpacked from it into their layer. Prefetched frames are
+// detiled and encoded by the reader thread (encodeBlocks) instead, which is also the fallback if the GPU
+// encoder doesn't build.
+bool compressFrames = false;
+BlockEncoding frameEncoding = BlockEncoding::BC7;
+GLuint blockBuffer, bcEncodeProgram;
+std::thread prefetchThread;
+std::mutex prefetchMutex;
+std::condition_variable prefetchCv;
+bool stopPrefetch = false;
+// Frames for the reader to load, nearest first, and the loaded ones that aren't in frameCache yet (their
+// blocks with compressFrames)
+std::vector<size_t> prefetchWanted;
+std::map<size_t, std::unique_ptr<uint8_t[]>> prefetched;
+
+// A missing or short dump reads as black past its end
+std::unique_ptr<uint8_t[]> readTimelineFrame(size_t frame) {
+  auto data = std::make_unique<uint8_t[]>(pitch);
+  std::ifstream file(timelineDumps[frame], std::ios::in | std::ios::binary);
+  if (!file)
+    std::cout << "Failed to open " << timelineDumps[frame] << "!" << std::endl;
+  else if (!file.read(reinterpret_cast<char*>(data.get()), pitch))
+    std::cout << timelineDumps[frame] << " is shorter than the surface" << std::endl;
+  std::fill(data.get() + file.gcount(), data.get() + pitch, 0);
+  return data;
+}
+
+// EXT_texture_compression_s3tc isn't in glad's core 4.3 profile either
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+
+GLenum frameCacheFormat() {
+  if (!compressFrames)
+    return GL_R32UI;
+  return frameEncoding == BlockEncoding::BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_BPTC_UNORM;
+}
+
+size_t encodedFrameSize() {
+  return static_cast<size_t>(resWidth / 4) * (resHeight / 4) * encodedBlockSize(frameEncoding);
+}
+
+// sRGB views of the cache layers. Compressed frames are plain RGBA, no swizzle.
+GLuint createFrameSRGBView(GLuint source) {
+  if (!compressFrames)
+    return createSRGBView(source);
+  GLuint view;
+  glGenTextures(1, &view);
+  glTextureView(view, GL_TEXTURE_2D, source,
+                frameEncoding == BlockEncoding::BC1 ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+                                                    : GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,
+                0, 1, 0, 1);
+  glBindTexture(GL_TEXTURE_2D, view);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  return view;
+}
+
+bool initTimeline() {
+  size_t frameSize = static_cast<size_t>(resWidth) * resHeight * 4;
+  if (compressFrames) {
+    if (frameEncoding == BlockEncoding::BC1 && !extensionSupported("GL_EXT_texture_compression_s3tc")) {
+      std::cout << "No GL_EXT_texture_compression_s3tc, compressing frames to BC7" << std::endl;
+      frameEncoding = BlockEncoding::BC7;
+    }
+    frameSize = encodedFrameSize();
+    glGenBuffers(1, &blockBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, blockBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(frameSize), nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    const std::string defines = "#define BC7 " + std::to_string(frameEncoding == BlockEncoding::BC7) +
+                                "\n#define BLOCKS_X " + std::to_string(resWidth / 4) +
+                                "\n#define BLOCKS_Y " + std::to_string(resHeight / 4) + "\n";
+    bcEncodeProgram = shaderVariants.get(bcEncodeComputeShaderSource, defines);
+    if (!bcEncodeProgram)
+      std::cout << "GPU block encoder unavailable, encoding frames on the CPU" << std::endl;
+  }
+  const size_t layers = std::min(std::max<size_t>(frameCacheBudget / frameSize, 1), timelineDumps.size());
+  if (!frameCache.init(resWidth, resHeight, frameCacheFormat(), layers, srgbOutput ? createFrameSRGBView : nullptr))
+    return false;
+  std::cout << "Frame cache: " << frameCache.capacity() << " frames"
+            << (compressFrames ? frameEncoding == BlockEncoding::BC1 ? " (BC1)" : " (BC7)" : "") << std::endl;
+  return true;
+}
+
+// CPU side of a compressed frame: detile (and decode BCn) to ARGB, then encode the padded texture size
+std::unique_ptr<uint8_t[]> encodeTimelineFrame(const uint8_t* dump) {
+  std::vector<uint32_t> linear(static_cast<size_t>(internalWidth) * internalHeight);
+  if (isBlockCompressed(surfaceFormat))
+    detileDecodeBC(dump, linear.data(), internalWidth, internalHeight, surfaceFormat, endianSwap);
+  else
+    detileFramebuffer(reinterpret_cast<const uint32_t*>(dump), linear.data(), internalWidth, internalHeight);
+  std::vector<uint32_t> padded(static_cast<size_t>(resWidth) * resHeight);
+  for (int y = 0; y < internalHeight; y++)
+    std::copy_n(linear.begin() + static_cast<size_t>(y) * internalWidth, internalWidth,
+                padded.begin() + static_cast<size_t>(y) * resWidth);
+  auto blocks = std::make_unique<uint8_t[]>(encodedFrameSize());
+  encodeBlocks(padded.data(), blocks.get(), resWidth, resHeight, frameEncoding);
+  return blocks;
+}
+
+// Compressed layer from blocks, a pointer or an offset into the bound GL_PIXEL_UNPACK_BUFFER
+void uploadBlocks(int layer, const void* blocks) {
+  glBindTexture(GL_TEXTURE_2D_ARRAY, frameCache.array());
+  glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, resWidth, resHeight, 1, frameCacheFormat(),
+                            static_cast<GLsizei>(encodedFrameSize()), blocks);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+// Caches frame from its dump, or from its blocks if encoded (prefetched into a compressed cache)
+int cacheFrame(size_t frame, const uint8_t* data, bool encoded) {
+  if (compressFrames && !encoded && !bcEncodeProgram)
+    return cacheFrame(frame, encodeTimelineFrame(data).get(), true);
+  const int layer = frameCache.insert(frame);
+  if (encoded) {
+    uploadBlocks(layer, data);
+    return layer;
+  }
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, pixelBuffer);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, pitch, data);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  if (detileInput == DetileInput::Texture2D)
+    uploadTiledTexture(0, pitch);
+  if (!compressFrames) {
+    // The detile kernels write image unit 0, pointed at the layer for this one
+    glBindImageTexture(0, frameCache.array(), 0, GL_FALSE, layer, GL_READ_WRITE, GL_R32UI);
+    computeDispatch();
+    glBindImageTexture(0, texture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+    return layer;
+  }
+  // Detiled into texture as usual, the encoder reads it through image unit 0
+  computeDispatch();
+  glUseProgram(bcEncodeProgram);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, blockBuffer);
+  glDispatchCompute((resWidth / 4 + 7) / 8, (resHeight / 4 + 7) / 8, 1);
+  glMemoryBarrier(GL_PIXEL_BUFFER_BARRIER_BIT);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, blockBuffer);
+  uploadBlocks(layer, nullptr);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  return layer;
+}
+
+void prefetchLoop() {
+  std::unique_lock lock(prefetchMutex);
+  while (true) {
+    prefetchCv.wait(lock, [] { return stopPrefetch || !prefetchWanted.empty(); });
+    if (stopPrefetch)
+      return;
+    const size_t frame = prefetchWanted.front();
+    prefetchWanted.erase(prefetchWanted.begin());
+    if (prefetched.count(frame))
+      continue;
+    lock.unlock();
+    std::unique_ptr<uint8_t[]> data = readTimelineFrame(frame);
+    if (compressFrames)
+      data = encodeTimelineFrame(data.get());
+    lock.lock();
+    prefetched[frame] = std::move(data);
+  }
+}
+
+// Before render() in the timeline viewer: makes timelineFrame what the present pass shows, caches one
+// prefetched frame and points the reader at the next ones
+void updateTimeline() {
+  // Read ahead no further than the cache holds next to the frame on screen
+  const int64_t depth = static_cast<int64_t>(std::min<size_t>(8, frameCache.capacity() - 1));
+  // How far frame is ahead of timelineFrame in the scrub direction, negative behind it
+  const auto distance = [](size_t frame) {
+    return (static_cast<int64_t>(frame) - static_cast<int64_t>(timelineFrame)) * timelineDirection;
+  };
+  std::unique_ptr<uint8_t[]> current;
+  std::pair<size_t, std::unique_ptr<uint8_t[]>> ahead;
+  {
+    const std::lock_guard lock(prefetchMutex);
+    // Frames the scrub left behind or turned away from would only evict ones that are still wanted
+    std::erase_if(prefetched, [&](const auto& entry) {
+      const int64_t d = distance(entry.first);
+      return d < 0 || d > depth;
+    });
+    if (const auto it = prefetched.find(timelineFrame); it != prefetched.end()) {
+      current = std::move(it->second);
+      prefetched.erase(it);
+    } else if (!prefetched.empty()) {
+      // Nearest first, like the reader loads them
+      const auto nearest = std::min_element(prefetched.begin(), prefetched.end(), [&](const auto& a, const auto& b) {
+        return distance(a.first) < distance(b.first);
+      });
+      ahead = std::move(*nearest);
+      prefetched.erase(nearest);
+    }
+  }
+  int layer = frameCache.find(timelineFrame);
+  if (layer < 0) {
+    // Scrubbed past the reader, nothing to do but wait for the disk
+    if (current)
+      layer = cacheFrame(timelineFrame, current.get(), compressFrames);
+    else
+      layer = cacheFrame(timelineFrame, readTimelineFrame(timelineFrame).get(), false);
+  } else if (ahead.second && !frameCache.contains(ahead.first)) {
+    cacheFrame(ahead.first, ahead.second.get(), compressFrames);
+  }
+
+  detiledTexture = frameCache.view(layer);
+  detiledTextureSRGB = frameCache.srgbView(layer);
+  if (timelineFrame != shownFrame) {
+    if (scalerEnabled)
+      scalerDispatch();
+    upscaleDirty = true;
+    shownFrame = timelineFrame;
+    const std::string title = "Xenon FB Conversion - " + std::string(timelineDumps[timelineFrame]) + " (" +
+                              std::to_string(timelineFrame + 1) + "/" + std::to_string(timelineDumps.size()) + ")";
+    SDL_SetWindowTitle(window, title.c_str());
+  }
+
+  std::vector<size_t> wanted;
+  for (int64_t i = 1; i <= depth; i++) {
+    const int64_t frame = static_cast<int64_t>(timelineFrame) + timelineDirection * i;
+    if (frame < 0 || frame >= static_cast<int64_t>(timelineDumps.size()))
+      break;
+    if (!frameCache.contains(static_cast<size_t>(frame)))
+      wanted.push_back(static_cast<size_t>(frame));
+  }
+  {
+    const std::lock_guard lock(prefetchMutex);
+    prefetchWanted = std::move(wanted);
+  }
+  prefetchCv.notify_one();
+}
+
+void render() {
+  passPixelBuffer();
+  if (surfaceDirty) {
+    // Dispatch compute shader to unswizzle data
+    computeDispatch();
+
+    // Stop anything from updating texture after finishing CS
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+    if (scalerEnabled && !isHDR(surfaceFormat))
+      scalerDispatch();
+    surfaceDirty = false;
+    upscaleDirty = true;
+  }
+  if (isHDR(surfaceFormat))
+    exposureDispatch();
+
+  GLuint presentTexture = detiledTexture;
+  // Only the detiled/HDR textures carry tile padding
+  float uvScaleX = static_cast<float>(internalWidth) / resWidth;
+  float uvScaleY = static_cast<float>(internalHeight) / resHeight;
+  if (!isHDR(surfaceFormat) && (scalerEnabled || presentFilter != PresentFilter::Nearest)) {
+    presentTexture = scalerEnabled ? scaledTexture : detiledTexture;
+    uvScaleX = uvScaleY = 1.0f;
+    if (presentFilter != PresentFilter::Nearest) {
+      if (upscaleDirty) {
+        upscaleDispatch(presentTexture);
+        upscaleDirty = false;
+      }
+      presentTexture = upscaledTexture;
+    }
+  }
+
+  // Letterbox bars, then draw the image into its rect
+  glViewport(0, 0, drawableWidth, drawableHeight);
+  glClear(GL_COLOR_BUFFER_BIT);
+  glViewport(presentRect.x, presentRect.y, presentRect.w, presentRect.h);
+
+  // Draw fullscreen rect
+  GLuint presentProgram;
+  if (srgbOutput)
+    glEnable(GL_FRAMEBUFFER_SRGB);
+  if (isHDR(surfaceFormat)) {
+    presentProgram = tonemapShaderProgram;
+    glUseProgram(presentProgram);
+    glUniform1i(glGetUniformLocation(presentProgram, "u_hardwareSRGB"), srgbOutput);
+    glBindTexture(GL_TEXTURE_2D, hdrTexture);
+  } else if (srgbOutput || compressFrames) {
+    // Compressed frames decode in the sampler, straight through the float sampling program
+    presentProgram = srgbShaderProgram;
+    glUseProgram(presentProgram);
+    if (presentTexture == scaledTexture)
+      glBindTexture(GL_TEXTURE_2D, scaledTextureSRGB);
+    else if (presentTexture == upscaledTexture)
+      glBindTexture(GL_TEXTURE_2D, upscaledTextureSRGB);
+    else
+      glBindTexture(GL_TEXTURE_2D, srgbOutput ? detiledTextureSRGB : detiledTexture);
+  } else {
+    presentProgram = renderShaderProgram;
+    glUseProgram(presentProgram);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_1D, gammaTexture);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, presentTexture);
+  }
+  glUniform2f(glGetUniformLocation(presentProgram, "u_uvScale"), uvScaleX, uvScaleY);
+  glBindVertexArray(dummyVAO);
+  glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+  if (srgbOutput)
+    glDisable(GL_FRAMEBUFFER_SRGB);
+
+  // Swap
+  SDL_GL_SwapWindow(window);
+}
+
+void shutdownRender() {
+  shaderVariants.clear();
+  frameCache.destroy();
+  glDeleteBuffers(1, &blockBuffer);
+  glDeleteProgram(bcShaderProgram);
+  glDeleteTextures(1, &tiledBufferTexture);
+  glDeleteTextures(1, &tiledTexture);
+  glDeleteTextures(1, &gammaTexture);
+  glDeleteProgram(srgbShaderProgram);
+  if (srgbOutput)
+    glDeleteTextures(1, &textureSRGB);
+  glDeleteProgram(hdrShaderProgram);
+  glDeleteProgram(exposureShaderProgram);
+  glDeleteProgram(tonemapShaderProgram);
+  glDeleteTextures(1, &hdrTexture);
+  glDeleteBuffers(1, &luminanceBuffer);
+  if (scalerEnabled) {
+    glDeleteProgram(scalerHShaderProgram);
+    glDeleteProgram(scalerVShaderProgram);
+    glDeleteTextures(1, &intermediateTexture);
+    glDeleteTextures(1, &scaledTexture);
+    if (srgbOutput)
+      glDeleteTextures(1, &scaledTextureSRGB);
+    glDeleteBuffers(2, scalerCoefficients);
+  }
+  glDeleteProgram(upscaleHShaderProgram);
+  glDeleteProgram(upscaleVShaderProgram);
+  if (upscaledTexture) {
+    glDeleteTextures(1, &upscaleIntermediateTexture);
+    glDeleteTextures(1, &upscaledTexture);
+    if (srgbOutput)
+      glDeleteTextures(1, &upscaledTextureSRGB);
+  }
+  SDL_GL_DestroyContext(context);
+  SDL_DestroyWindow(window);
+}
+
+bool parseFormat(const std::string& name) {
+  if (name == "8888")
+    surfaceFormat = SurfaceFormat::k_8_8_8_8;
+  else if (name == "dxt1")
+    surfaceFormat = SurfaceFormat::k_DXT1;
+  else if (name == "dxt3")
+    surfaceFormat = SurfaceFormat::k_DXT2_3;
+  else if (name == "dxt5")
+    surfaceFormat = SurfaceFormat::k_DXT4_5;
+  else if (name == "dxn")
+    surfaceFormat = SurfaceFormat::k_DXN;
+  else if (name == "7e3")
+    surfaceFormat = SurfaceFormat::k_2_10_10_10_FLOAT;
+  else if (name == "fp16")
+    surfaceFormat = SurfaceFormat::k_16_16_16_16_FLOAT;
+  else
+    return false;
+  return true;
+}
+
+// Converts on the CPU and writes the result, no window needed
+// --mmap output: the file is sized up front and mapped, rows are stored into the mapping instead of going
+// through write(). Raw output of the whole surface is written by the detiler itself, no staging at all.
+int convertToMappedFile(const char* outputPath, uint8_t* tiled, uint32_t width, uint32_t height, const Region& crop) {
+  const ImageFormat format = imageFormatFromPath(outputPath);
+  if (!hasFixedRows(format)) {
+    std::cout << "--mmap can only write raw, PPM and PAM images" << std::endl;
+    return 1;
+  }
+  const GammaLut* gamma = gammaEnabled ? &gammaLut : nullptr;
+  const std::string header = imageHeader(format, crop.width, crop.height);
+  const uint64_t rowSize = static_cast<uint64_t>(crop.width) * bytesPerPixel(format);
+  MappedFile file;
+  if (!file.create(outputPath, header.size() + rowSize * crop.height))
+    return 1;
+  std::memcpy(file.data(), header.data(), header.size());
+  uint8_t* image = file.data() + header.size();
+  const bool direct = format == ImageFormat::Raw && !gamma && crop.x == 0 && crop.y == 0 && crop.width == width &&
+                      crop.height == height;
+
+  if (isHDR(surfaceFormat)) {
+    if (direct) {
+      detileTonemap(tiled, reinterpret_cast<uint32_t*>(image), width, height, surfaceFormat, tonemapOperator);
+    } else {
+      std::vector<uint32_t> linear(static_cast<size_t>(width) * height);
+      detileTonemap(tiled, linear.data(), width, height, surfaceFormat, tonemapOperator);
+      for (uint32_t y = 0; y < crop.height; y++)
+        convertRow(format, linear.data() + static_cast<uint64_t>(crop.y + y) * width + crop.x, image + y * rowSize,
+                   crop.width, gamma);
+    }
+    return file.close() ? 0 : 1;
+  }
+
+  // Same tile row loop as convertSurface, each finished band is handed to writeback right away
+  const uint32_t bandHeight = isBlockCompressed(surfaceFormat) ? 32 * 4 : 32;
+  const uint64_t bandSize = tiledRowSize(surfaceFormat, width);
+  std::vector<uint32_t> band(direct ? 0 : static_cast<size_t>(width) * bandHeight);
+  for (uint32_t y = crop.y - crop.y % bandHeight; y < crop.y + crop.height; y += bandHeight) {
+    const uint32_t rows = std::min(bandHeight, height - y);
+    const uint8_t* src = tiled + (y / bandHeight) * bandSize;
+    uint32_t* dst = direct ? reinterpret_cast<uint32_t*>(image + y * rowSize) : band.data();
+    if (isBlockCompressed(surfaceFormat))
+      detileDecodeBC(src, dst, width, rows, surfaceFormat, endianSwap);
+    else
+      detileFramebuffer(reinterpret_cast<const uint32_t*>(src), dst, width, rows);
+    const uint32_t first = std::max(y, crop.y);
+    const uint32_t last = std::min(y + rows, crop.y + crop.height);
+    if (!direct) {
+      for (uint32_t row = first; row < last; row++)
+        convertRow(format, band.data() + static_cast<uint64_t>(row - y) * width + crop.x,
+                   image + (row - crop.y) * rowSize, crop.width, gamma);
+    }
+    file.flush(header.size() + (first - crop.y) * rowSize, (last - first) * rowSize);
+  }
+  return file.close() ? 0 : 1;
+}
+
+// Converts a width x height tiled surface on the CPU and writes the crop rectangle of it to writer
+bool convertSurface(ImageWriter& writer, uint8_t* tiled, uint32_t width, uint32_t height, bool inPlace,
+                    const Region& crop) {
+  if (inPlace) {
+    // The dump buffer becomes the linear image, no second surface in memory
+    uint32_t* pixels = reinterpret_cast<uint32_t*>(tiled);
+    detileFramebufferInPlace(pixels, width, height);
+    return writer.writeRows(pixels + static_cast<uint64_t>(crop.y) * width + crop.x, crop.height, width) &&
+           writer.finish();
+  }
+  if (isHDR(surfaceFormat)) {
+    // Exposure is metered over the whole surface first, no way around a full linear copy
+    std::vector<uint32_t> linear(static_cast<size_t>(width) * height);
+    detileTonemap(tiled, linear.data(), width, height, surfaceFormat, tonemapOperator);
+    return writer.writeRows(linear.data() + static_cast<uint64_t>(crop.y) * width + crop.x, crop.height, width) &&
+           writer.finish();
+  }
+
+  // One row of tiles at a time: detile it into a small scratch (160KB for a 1280 wide 8888 surface)
+  // and hand it straight to the encoder while it's still in cache. A tile row is a tiled surface of
+  // its own, so the regular detilers run on it unchanged.
+  const uint32_t bandHeight = isBlockCompressed(surfaceFormat) ? 32 * 4 : 32;
+  const uint64_t bandSize = tiledRowSize(surfaceFormat, width);
+  std::vector<uint32_t> band(static_cast<size_t>(width) * bandHeight);
+  for (uint32_t y = crop.y - crop.y % bandHeight; y < crop.y + crop.height; y += bandHeight) {
+    const uint32_t rows = std::min(bandHeight, height - y);
+    const uint8_t* src = tiled + (y / bandHeight) * bandSize;
+    if (isBlockCompressed(surfaceFormat))
+      detileDecodeBC(src, band.data(), width, rows, surfaceFormat, endianSwap);
+    else
+      detileFramebuffer(reinterpret_cast<const uint32_t*>(src), band.data(), width, rows);
+    // Just the rows of the band inside the crop
+    const uint32_t first = std::max(y, crop.y);
+    const uint32_t last = std::min(y + rows, crop.y + crop.height);
+    if (!writer.writeRows(band.data() + static_cast<uint64_t>(first - y) * width + crop.x, last - first, width))
+      return false;
+  }
+  return writer.finish();
+}
+
+int convertToFile(const char* outputPath, uint8_t* tiled, uint32_t width, uint32_t height, bool inPlace,
+                  bool mapOutput, const Region& crop) {
+  if (mapOutput && !inPlace)
+    return convertToMappedFile(outputPath, tiled, width, height, crop);
+  ImageWriter writer(outputPath, crop.width, crop.height, gammaEnabled ? &gammaLut : nullptr);
+  return writer && convertSurface(writer, tiled, width, height, inPlace, crop) ? 0 : 1;
+}
+
+// Batched GPU conversion (--gpu-batch): up to frameCount dumps go into one SSBO and are detiled by one dispatch,
+// z picking the frame and the layer of a texture array. Two sets of buffers alternate, so while one batch is
+// being detiled and read back into its pack buffer the CPU loads the next one and writes out the one before.
+struct GpuBatch {
+  GLuint input;    // frameCount tiled dumps back to back
+  GLuint frames;   // R32UI array, a layer per frame
+  GLuint readback; // Pack buffer the array is copied into
+  GLsync fence = nullptr;
+  std::vector<size_t> dumps; // Indices of the dumps in flight
+};
+
+bool finishGpuBatch(GpuBatch& batch, BatchOutput& output, size_t& failed) {
+  if (!batch.fence)
+    return true;
+  glClientWaitSync(batch.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+  glDeleteSync(batch.fence);
+  batch.fence = nullptr;
+  const size_t frameSize = static_cast<size_t>(resWidth) * resHeight;
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, batch.readback);
+  const uint32_t* pixels = static_cast<const uint32_t*>(
+      glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameSize * batch.dumps.size() * 4, GL_MAP_READ_BIT));
+  if (!pixels) {
+    std::cout << "Failed to map the readback buffer" << std::endl;
+    return false;
+  }
+  for (size_t i = 0; i < batch.dumps.size(); i++) {
+    // Layers keep the tile padding, crop it off with the stride
+    const uint32_t* frame = pixels + i * frameSize;
+    const std::string& name = output.imageName(batch.dumps[i]);
+    if (!output.write(name, [&](ImageWriter& writer) {
+          return writer.writeRows(frame, internalHeight, resWidth) && writer.finish();
+        })) {
+      std::cout << "Failed to write " << name << "!" << std::endl;
+      failed++;
+    }
+  }
+  glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  batch.dumps.clear();
+  return true;
+}
+
+size_t convertBatchGPU(const std::vector<const char*>& dumps, BatchOutput& output, int frameCount) {
+  if (initSDL("Xenon FB Conversion", resWidth, resHeight, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN) != 0)
+    return dumps.size();
+  initOpenGL();
+  // The walker, frame z of the batch into layer z
+  const GLuint batchProgram = detileProgram(DetileKernel::Walker, DetileInput::SSBO, true);
+  if (!batchProgram) {
+    shutdownRender();
+    SDL_Quit();
+    return dumps.size();
+  }
+
+  // Batches are capped by the SSBO size and array layer limits
+  GLint64 maxBlockSize = 0;
+  GLint maxLayers = 0;
+  glGetInteger64v(GL_MAX_SHADER_STORAGE_BLOCK_SIZE, &maxBlockSize);
+  glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+  frameCount = static_cast<int>(std::min<int64_t>({frameCount, maxBlockSize / static_cast<int64_t>(pitch), maxLayers,
+                                                    static_cast<int64_t>(dumps.size())}));
+  frameCount = std::max(frameCount, 1);
+  const size_t frameSize = static_cast<size_t>(resWidth) * resHeight * 4;
+  std::cout << "GPU batches of " << frameCount << " frames" << std::endl;
+
+  GpuBatch batches[2];
+  for (GpuBatch& batch : batches) {
+    glGenBuffers(1, &batch.input);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.input);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, pitch * frameCount, nullptr, GL_STREAM_DRAW);
+    glGenTextures(1, &batch.frames);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, batch.frames);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_R32UI, resWidth, resHeight, frameCount);
+    glGenBuffers(1, &batch.readback);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, batch.readback);
+    glBufferData(GL_PIXEL_PACK_BUFFER, frameSize * frameCount, nullptr, GL_STREAM_READ);
+  }
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  GLuint layerReader;
+  glGenFramebuffers(1, &layerReader);
+
+  size_t failed = 0;
+  size_t next = 0;
+  uint32_t index = 0;
+  for (; next < dumps.size(); index++) {
+    GpuBatch& batch = batches[index & 1];
+    // Frees this set of buffers, the other batch keeps the GPU busy meanwhile
+    if (!finishGpuBatch(batch, output, failed))
+      break;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.input);
+    uint8_t* input = static_cast<uint8_t*>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, pitch * frameCount,
+                                                            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (!input) {
+      std::cout << "Failed to map the batch buffer" << std::endl;
+      break;
+    }
+    while (next < dumps.size() && batch.dumps.size() < static_cast<size_t>(frameCount)) {
+      const size_t dump = next++;
+      std::ifstream f(dumps[dump], std::ios::in | std::ios::binary);
+      if (!f) {
+        std::cout << "Failed to open " << dumps[dump] << "!" << std::endl;
+        failed++;
+        continue;
+      }
+      uint8_t* slot = input + batch.dumps.size() * pitch;
+      f.read(reinterpret_cast<char*>(slot), pitch);
+      // Short dumps convert like they do on their own, the missing part is black
+      std::memset(slot + f.gcount(), 0, pitch - static_cast<size_t>(f.gcount()));
+      batch.dumps.push_back(dump);
+    }
+    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    if (batch.dumps.empty())
+      break;
+
+    glUseProgram(batchProgram);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, batch.input);
+    glBindImageTexture(7, batch.frames, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R32UI);
+    glDispatchCompute((resWidth / 32 + 7) / 8, (resHeight + 7) / 8, static_cast<GLuint>(batch.dumps.size()));
+    glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+
+    // Queued behind the dispatch, the fence says when the pack buffer can be mapped. Only the layers this
+    // batch filled are read, a short last batch doesn't copy the rest of the array. Core 4.3 has no
+    // glGetTextureSubImage, so each layer goes through the read framebuffer.
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, layerReader);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, batch.readback);
+    for (size_t i = 0; i < batch.dumps.size(); i++) {
+      glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, batch.frames, 0, static_cast<GLint>(i));
+      glReadPixels(0, 0, resWidth, internalHeight, GL_RED_INTEGER, GL_UNSIGNED_INT,
+                   reinterpret_cast<void*>(i * frameSize));
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+  }
+  // Oldest first, the images come out in command line order
+  finishGpuBatch(batches[index & 1], output, failed);
+  finishGpuBatch(batches[(index + 1) & 1], output, failed);
+  for (GpuBatch& batch : batches) {
+    // Anything still listed never made it out
+    failed += batch.dumps.size();
+    glDeleteBuffers(1, &batch.input);
+    glDeleteTextures(1, &batch.frames);
+    glDeleteBuffers(1, &batch.readback);
+  }
+  // Nor did the dumps a GL error stopped before they were loaded
+  failed += dumps.size() - next;
+  glDeleteFramebuffers(1, &layerReader);
+  shutdownRender();
+  SDL_Quit();
+  return failed;
+}
+
+// --batch: converts every dump given to output/<dump name>.<format> (see BatchOutput::nameImages), reusing the one
+// surface buffer. When output is a .tar or .zip the images go into that one archive instead, encoded in memory and
+// appended by the archive's writer thread while the next dump converts.
+// --direct-io writes the files (or the archive) through DirectFile so a long export doesn't push everything else
+// out of the page cache.
+int convertBatch(const std::vector<const char*>& dumps, const char* outputPath, ImageFormat format, bool inPlace,
+                 bool directIO, int gpuFrames) {
+  pitch = tiledSurfaceSize(surfaceFormat, internalWidth, internalHeight);
+  const Region fullSurface = {0, 0, static_cast<uint32_t>(internalWidth), static_cast<uint32_t>(internalHeight)};
+  BatchOutput output(format, fullSurface.width, fullSurface.height, gammaEnabled ? &gammaLut : nullptr);
+  if (!output.nameImages(dumps) || !output.open(outputPath, directIO))
+    return 1;
+
+  size_t failed = 0;
+  if (gpuFrames) {
+    failed = convertBatchGPU(dumps, output, gpuFrames);
+  } else {
+    buffer = std::make_unique<uint8_t[]>(pitch);
+    for (size_t i = 0; i < dumps.size(); i++) {
+      std::ifstream f(dumps[i], std::ios::in | std::ios::binary);
+      if (!f) {
+        std::cout << "Failed to open " << dumps[i] << "!" << std::endl;
+        failed++;
+        continue;
+      }
+      // Short dumps convert like they do on their own, the missing part is black
+      std::memset(buffer.get(), 0, pitch);
+      f.read(reinterpret_cast<char*>(buffer.get()), pitch);
+      const std::string& name = output.imageName(i);
+      if (!output.write(name, [&](ImageWriter& writer) {
+            return convertSurface(writer, buffer.get(), internalWidth, internalHeight, inPlace, fullSurface);
+          })) {
+        std::cout << "Failed to write " << name << "!" << std::endl;
+        failed++;
+      }
+    }
+  }
+  if (!output.close())
+    return 1;
+  std::cout << "Converted " << dumps.size() - failed << " of " << dumps.size() << " dumps" << std::endl;
+  return failed ? 1 : 0;
+}
+
+// FNV-1a over the visible pixels in linear order, read straight from the tiled dump
+uint64_t surfaceHash(const TiledSurfaceView& view) {
+  uint64_t hash = 0xCBF29CE484222325;
+  for (const uint32_t pixel : view.pixels()) {
+    hash ^= pixel;
+    hash *= 0x100000001B3;
+  }
+  return hash;
+}
+
+// Times every CPU detile backend this machine supports on the loaded framebuffer
+int runBench(int iterations) {
+  if (surfaceFormat != SurfaceFormat::k_8_8_8_8) {
+    std::cout << "--bench only supports the 8888 framebuffer" << std::endl;
+    return 1;
+  }
+  std::vector<uint32_t> linear(static_cast<size_t>(internalWidth) * internalHeight);
+  const double bytes = static_cast<double>(linear.size()) * sizeof(uint32_t) * 2;
+  for (const CpuBackend backend : {CpuBackend::Scalar, CpuBackend::SSE2, CpuBackend::AVX2, CpuBackend::AVX512,
+                                    CpuBackend::NEON, CpuBackend::JIT}) {
+    if (!cpuBackendSupported(backend))
+      continue;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+      detileFramebuffer(reinterpret_cast<const uint32_t*>(buffer.get()), linear.data(), internalWidth, internalHeight,
+                        backend);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+    std::cout << cpuBackendName(backend) << ": " << seconds * 1000.0 << " ms/frame, " << bytes / seconds / 1e9
+              << " GB/s" << std::endl;
+  }
+  return 0;
+}
+
+// --bench-gpu: times every 8888 kernel reading through each DetileInput (in a hidden window), and checks their
+// output against the CPU detiler. The 2D texture input has to be copied out of pixelBuffer first, that copy
+// is timed on its own.
+int runGpuBench(int iterations) {
+  if (surfaceFormat != SurfaceFormat::k_8_8_8_8) {
+    std::cout << "--bench-gpu only supports the 8888 framebuffer" << std::endl;
+    return 1;
+  }
+  if (initSDL("Xenon FB Conversion", resWidth, resHeight, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN) != 0)
+    return 1;
+  initOpenGL();
+  std::cout << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION) << std::endl;
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, pixelBuffer);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, pitch, buffer.get());
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  std::vector<uint32_t> reference(static_cast<size_t>(internalWidth) * internalHeight);
+  detileFramebuffer(reinterpret_cast<const uint32_t*>(buffer.get()), reference.data(), internalWidth, internalHeight);
+  std::vector<uint32_t> result(static_cast<size_t>(resWidth) * resHeight);
+
+  const double bytes = static_cast<double>(result.size()) * sizeof(uint32_t) * 2;
+  // Wall time of one call to run, averaged over iterations after a warm up call. Timer queries would leave out
+  // the submission cost, and some drivers don't implement them.
+  const auto time = [&](const auto& run) {
+    run();
+    glFinish();
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+      run();
+    glFinish();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+  };
+
+  static const char* kernelNames[] = {"pixel", "walker", "shuffle"};
+  static const char* inputNames[] = {"ssbo", "buffer", "texture"};
+  const bool shuffleSupported = subgroupShuffleSupported();
+  if (!shuffleSupported)
+    std::cout << "No GL_KHR_shader_subgroup shuffles, skipping the shuffle kernel" << std::endl;
+  for (const DetileInput input : {DetileInput::SSBO, DetileInput::TextureBuffer, DetileInput::Texture2D}) {
+    if (!initTiledInput(input))
+      continue;
+    if (input == DetileInput::Texture2D) {
+      const double seconds = time([] { uploadTiledTexture(0, pitch); });
+      std::cout << "texture upload: " << seconds * 1000.0 << " ms/frame" << std::endl;
+    }
+    for (const DetileKernel kernel : {DetileKernel::PerPixel, DetileKernel::Walker, DetileKernel::Shuffle}) {
+      if (kernel == DetileKernel::Shuffle && !shuffleSupported)
+        continue;
+      const GLuint program = detileProgram(kernel, input);
+      if (!program)
+        continue;
+      const double seconds = time([&] { dispatchDetile(program, kernel, input); });
+
+      glBindTexture(GL_TEXTURE_2D, texture);
+      glGetTexImage(GL_TEXTURE_2D, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, result.data());
+      glBindTexture(GL_TEXTURE_2D, 0);
+      bool matches = true;
+      for (int y = 0; y < internalHeight && matches; y++)
+        matches = std::equal(reference.begin() + static_cast<size_t>(y) * internalWidth,
+                             reference.begin() + static_cast<size_t>(y + 1) * internalWidth,
+                             result.begin() + static_cast<size_t>(y) * resWidth);
+
+      std::cout << kernelNames[static_cast<int>(kernel)] << "/" << inputNames[static_cast<int>(input)] << ": "
+                << seconds * 1000.0 << " ms/frame, " << bytes / seconds / 1e9 << " GB/s"
+                << (matches ? "" : " (doesn't match the CPU!)") << std::endl;
+    }
+  }
+  shutdownRender();
+  SDL_Quit();
+  return 0;
+}
+
+int main(int argc, char* argv[]) {
+  std::vector<const char*> dumpPaths;
+  const char* outputPath = nullptr;
+  const char* batchDir = nullptr;
+  ImageFormat batchFormat = ImageFormat::PAM;
+  bool directIO = false;
+  int gpuFrames = 0;
+  bool windowSizeSet = false;
+  bool hashOnly = false;
+  bool gpuBench = false;
+  bool inPlace = false;
+  bool mapFiles = false;
+  Region region;
+  int benchIterations = 0;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--size" && i + 1 < argc) {
+      if (std::sscanf(argv[++i], "%dx%d", &internalWidth, &internalHeight) != 2 || internalWidth <= 0 ||
+          internalHeight <= 0) {
+        std::cout << "Invalid size: " << argv[i] << std::endl;
+        return 1;
+      }
+    } else if (arg == "--format" && i + 1 < argc) {
+      if (!parseFormat(argv[++i])) {
+        std::cout << "Unknown format: " << argv[i] << std::endl;
+        return 1;
+      }
+    } else if (arg == "--tonemap" && i + 1 < argc) {
+      const std::string op = argv[++i];
+      if (op == "reinhard") {
+        tonemapOperator = Tonemap::Reinhard;
+      } else if (op == "aces") {
+        tonemapOperator = Tonemap::ACES;
+      } else {
+        std::cout << "Unknown tonemap operator: " << op << std::endl;
+        return 1;
+      }
+    } else if (arg == "--scaler" && i + 1 < argc) {
+      if (!parseOutputMode(argv[++i], scalerConfig)) {
+        std::cout << "Unknown output mode: " << argv[i] << std::endl;
+        return 1;
+      }
+      scalerEnabled = true;
+    } else if (arg == "--taps" && i + 1 < argc) {
+      scalerConfig.taps = std::atoi(argv[++i]);
+      if (scalerConfig.taps < 2 || scalerConfig.taps > 16 || scalerConfig.taps % 2) {
+        std::cout << "Taps have to be even, between 2 and 16" << std::endl;
+        return 1;
+      }
+    } else if (arg == "--filter" && i + 1 < argc) {
+      const std::string filter = argv[++i];
+      if (filter == "nearest") {
+        presentFilter = PresentFilter::Nearest;
+      } else if (filter == "bicubic") {
+        presentFilter = PresentFilter::Bicubic;
+      } else if (filter == "lanczos") {
+        presentFilter = PresentFilter::Lanczos3;
+      } else {
+        std::cout << "Unknown present filter: " << filter << std::endl;
+        return 1;
+      }
+    } else if (arg == "--window" && i + 1 < argc) {
+      if (std::sscanf(argv[++i], "%dx%d", &windowWidth, &windowHeight) != 2 || windowWidth <= 0 ||
+          windowHeight <= 0) {
+        std::cout << "Invalid window size: " << argv[i] << std::endl;
+        return 1;
+      }
+      windowSizeSet = true;
+    } else if (arg == "--srgb") {
+      srgbOutput = true;
+    } else if (arg == "--integer-scale") {
+      integerScale = true;
+    } else if (arg == "--kernel" && i + 1 < argc) {
+      const std::string kernel = argv[++i];
+      if (kernel == "pixel") {
+        detileKernel = DetileKernel::PerPixel;
+      } else if (kernel == "walker") {
+        detileKernel = DetileKernel::Walker;
+      } else if (kernel == "shuffle") {
+        detileKernel = DetileKernel::Shuffle;
+      } else {
+        std::cout << "Unknown detile kernel: " << kernel << std::endl;
+        return 1;
+      }
+    } else if (arg == "--input" && i + 1 < argc) {
+      const std::string input = argv[++i];
+      if (input == "ssbo") {
+        detileInput = DetileInput::SSBO;
+      } else if (input == "buffer") {
+        detileInput = DetileInput::TextureBuffer;
+      } else if (input == "texture") {
+        detileInput = DetileInput::Texture2D;
+      } else {
+        std::cout << "Unknown detile input: " << input << std::endl;
+        return 1;
+      }
+    } else if (arg == "--shader-cache" && i + 1 < argc) {
+      shaderVariants.setCacheDirectory(argv[++i]);
+    } else if (arg == "--no-swap") {
+      endianSwap = false;
+    } else if (arg == "--gamma" && i + 1 < argc) {
+      // Either a preset name or a dumped PWL ramp
+      const char* ramp = argv[++i];
+      if (!gammaPreset(ramp, gammaLut) && !loadGammaPWL(ramp, gammaLut))
+        return 1;
+      gammaEnabled = true;
+    } else if (arg == "--frame-cache" && i + 1 < argc) {
+      const int megabytes = std::atoi(argv[++i]);
+      if (megabytes <= 0) {
+        std::cout << "Invalid frame cache size: " << argv[i] << std::endl;
+        return 1;
+      }
+      frameCacheBudget = static_cast<size_t>(megabytes) << 20;
+    } else if (arg == "--frame-compression" && i + 1 < argc) {
+      const std::string encoding = argv[++i];
+      if (encoding == "bc1") {
+        frameEncoding = BlockEncoding::BC1;
+      } else if (encoding == "bc7") {
+        frameEncoding = BlockEncoding::BC7;
+      } else {
+        std::cout << "Unknown frame compression: " << encoding << std::endl;
+        return 1;
+      }
+      compressFrames = true;
+    } else if (arg == "--jit") {
+      if (!cpuBackendSupported(CpuBackend::JIT)) {
+        std::cout << "--jit needs an x64 CPU" << std::endl;
+        return 1;
+      }
+      setDetileBackend(CpuBackend::JIT);
+    } else if (arg == "--bench") {
+      benchIterations = 100;
+    } else if (arg == "--bench-gpu") {
+      benchIterations = 100;
+      gpuBench = true;
+    } else if (arg == "--hash") {
+      hashOnly = true;
+    } else if (arg == "--output" && i + 1 < argc) {
+      outputPath = argv[++i];
+    } else if (arg == "--in-place") {
+      inPlace = true;
+    } else if (arg == "--mmap") {
+      mapFiles = true;
+    } else if (arg == "--region" && i + 1 < argc) {
+      if (!parseRegion(argv[++i], region)) {
+        std::cout << "Invalid region: " << argv[i] << std::endl;
+        return 1;
+      }
+    } else if (arg == "--batch" && i + 1 < argc) {
+      batchDir = argv[++i];
+    } else if (arg == "--batch-format" && i + 1 < argc) {
+      if (!parseImageFormat(argv[++i], batchFormat)) {
+        std::cout << "Unknown image format: " << argv[i] << std::endl;
+        return 1;
+      }
+    } else if (arg == "--direct-io") {
+      directIO = true;
+    } else if (arg == "--gpu-batch" && i + 1 < argc) {
+      gpuFrames = std::atoi(argv[++i]);
+      if (gpuFrames <= 0) {
+        std::cout << "Invalid GPU batch size: " << argv[i] << std::endl;
+        return 1;
+      }
+    } else {
+      // Drag and drop passes the dump as the only argument
+      dumpPaths.push_back(argv[i]);
+    }
+  }
+  // Outside of --batch and the timeline viewer the last dump given wins
+  const char* dumpPath = dumpPaths.empty() ? "fbmem.bin" : dumpPaths.back();
+  resWidth = TILE(internalWidth);
+  resHeight = TILE(internalHeight);
+  if (srgbOutput && gammaEnabled) {
+    // The ramp indexes raw 8 bit values, which the sRGB path never sees
+    std::cout << "--gamma can't be combined with --srgb, ignoring --srgb" << std::endl;
+    srgbOutput = false;
+  }
+  if (scalerEnabled && isHDR(surfaceFormat)) {
+    // Float surfaces go through the tonemapper, the scaler only reads ARGB words
+    std::cout << "--scaler doesn't apply to float surfaces, ignoring it" << std::endl;
+    scalerEnabled = false;
+  }
+  if (!windowSizeSet) {
+    windowWidth = scalerEnabled ? scalerConfig.outputWidth : resWidth;
+    windowHeight = scalerEnabled ? scalerConfig.outputHeight : resHeight;
+  }
+  if (detileInput != DetileInput::SSBO && surfaceFormat != SurfaceFormat::k_8_8_8_8) {
+    // BCn and float surfaces have kernels of their own
+    std::cout << "--input only applies to the 8888 framebuffer, ignoring it" << std::endl;
+    detileInput = DetileInput::SSBO;
+  }
+  if (inPlace && surfaceFormat != SurfaceFormat::k_8_8_8_8) {
+    std::cout << "--in-place only supports the 8888 framebuffer" << std::endl;
+    return 1;
+  }
+  if ((directIO || gpuFrames) && !batchDir) {
+    std::cout << "--direct-io and --gpu-batch only work with --batch" << std::endl;
+    return 1;
+  }
+  if (gpuFrames && (surfaceFormat != SurfaceFormat::k_8_8_8_8 || inPlace)) {
+    std::cout << "--gpu-batch only supports the 8888 framebuffer, without --in-place" << std::endl;
+    return 1;
+  }
+  if (batchDir) {
+    if (dumpPaths.empty()) {
+      std::cout << "--batch needs at least one dump" << std::endl;
+      return 1;
+    }
+    if (region.width || mapFiles) {
+      std::cout << "--region and --mmap don't work with --batch" << std::endl;
+      return 1;
+    }
+    return convertBatch(dumpPaths, batchDir, batchFormat, inPlace, directIO, gpuFrames);
+  }
+  if (region.width) {
+    if (!outputPath) {
+      std::cout << "--region only works with --output" << std::endl;
+      return 1;
+    }
+    // In 64 bits, a huge offset would wrap the sum back inside the surface
+    if (static_cast<uint64_t>(region.x) + region.width > static_cast<uint64_t>(internalWidth) ||
+        static_cast<uint64_t>(region.y) + region.height > static_cast<uint64_t>(internalHeight)) {
+      std::cout << "Region is outside the surface" << std::endl;
+      return 1;
+    }
+    // Only the tiles under the region are read, they're converted as a surface of their own
+    const RegionTiles tiles = regionTiles(surfaceFormat, region);
+    auto data = std::make_unique<uint8_t[]>(tiledSurfaceSize(surfaceFormat, tiles.width, tiles.height));
+    if (!readRegionTiles(dumpPath, surfaceFormat, internalWidth, tiles, data.get()))
+      return 1;
+    return convertToFile(outputPath, data.get(), tiles.width, tiles.height, inPlace, mapFiles,
+                         {tiles.offsetX, tiles.offsetY, region.width, region.height});
+  }
+
+  pitch = tiledSurfaceSize(surfaceFormat, internalWidth, internalHeight);
+  const Region fullSurface = {0, 0, static_cast<uint32_t>(internalWidth), static_cast<uint32_t>(internalHeight)};
+  if (outputPath && mapFiles) {
+    // Converted straight out of the page cache, the dump is never copied into a buffer
+    MappedFile input;
+    if (!input.openRead(dumpPath))
+      return 1;
+    if (input.size() < pitch) {
+      std::cout << "Framebuffer dump is shorter than the surface" << std::endl;
+      return 1;
+    }
+    return convertToFile(outputPath, input.data(), internalWidth, internalHeight, inPlace, true, fullSurface);
+  }
+  // Several dumps in the viewer are the frames of a timeline
+  const bool timeline = dumpPaths.size() > 1 && !benchIterations && !hashOnly && !outputPath;
+  if (timeline && isHDR(surfaceFormat)) {
+    std::cout << "The timeline viewer doesn't support float surfaces" << std::endl;
+    return 1;
+  }
+  if (compressFrames && !timeline) {
+    std::cout << "--frame-compression only applies to the timeline viewer, ignoring it" << std::endl;
+    compressFrames = false;
+  }
+  if (compressFrames && (scalerEnabled || presentFilter != PresentFilter::Nearest || gammaEnabled)) {
+    // Those passes read the detiled words, compressed frames only come back out of a sampler
+    std::cout << "--frame-compression can't be combined with --scaler, --filter or --gamma" << std::endl;
+    return 1;
+  }
+  buffer = std::make_unique<uint8_t[]>(pitch);
+
+  std::cout << "Width: " << resWidth << std::endl;
+  std::cout << "Height: " << resHeight << std::endl;
+
+  std::ifstream f(dumpPath, std::ios::in | std::ios::binary);
+
+  if (!f)
+    std::cout << "Failed to open framebuffer dump!" << std::endl;
+  // Everything but the viewer needs the whole dump up front
+  const bool progressive = f && !benchIterations && !hashOnly && !outputPath && !timeline;
+  if (f && !progressive && !timeline)
+    f.read(reinterpret_cast<char*>(buffer.get()), pitch);
+
+  if (benchIterations)
+    return gpuBench ? runGpuBench(benchIterations) : runBench(benchIterations);
+
+  if (hashOnly) {
+    if (surfaceFormat != SurfaceFormat::k_8_8_8_8) {
+      std::cout << "--hash only supports the 8888 framebuffer" << std::endl;
+      return 1;
+    }
+    const TiledSurfaceView view(reinterpret_cast<const uint32_t*>(buffer.get()), internalWidth, internalHeight);
+    std::cout << std::hex << surfaceHash(view) << std::endl;
+    return 0;
+  }
+
+  if (outputPath)
+    return convertToFile(outputPath, buffer.get(), internalWidth, internalHeight, inPlace, false, fullSurface);
+
+  SDL_WindowFlags flags = SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY;
+  if (initSDL("Xenon FB Conversion", windowWidth, windowHeight, flags) != 0) {
+    return 1;
+  }
+
+  initOpenGL();
+  if (progressive)
+    loaderThread = std::thread(loadDump, std::move(f));
+  if (timeline) {
+    timelineDumps = dumpPaths;
+    if (!initTimeline()) {
+      shutdownRender();
+      SDL_Quit();
+      return 1;
+    }
+    // Frames only ever come out of the cache
+    surfaceDirty = false;
+    if (frameCache.capacity() > 1)
+      prefetchThread = std::thread(prefetchLoop);
+  }
+
+  bool running = true;
+  SDL_Event event;
+  while (running) {
+    while (SDL_PollEvent(&event)) {
+      if (event.type == SDL_EVENT_QUIT)
+        running = false;
+      if (event.type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED)
+        updatePresentRect();
+      // I toggles integer scaling
+      if (event.type == SDL_EVENT_KEY_DOWN && event.key.key == SDLK_I && !event.key.repeat) {
+        integerScale = !integerScale;
+        updatePresentRect();
+      }
+      // Left/Right step the timeline, key repeat scrubs
+      if (timeline && event.type == SDL_EVENT_KEY_DOWN &&
+          (event.key.key == SDLK_LEFT || event.key.key == SDLK_RIGHT)) {
+        timelineDirection = event.key.key == SDLK_LEFT ? -1 : 1;
+        if (timelineDirection < 0 && timelineFrame > 0)
+          timelineFrame--;
+        else if (timelineDirection > 0 && timelineFrame + 1 < timelineDumps.size())
+          timelineFrame++;
+      }
+    }
+    if (timeline)
+      updateTimeline();
+    render();
+  }
+
+  stopLoading = true;
+  if (loaderThread.joinable())
+    loaderThread.join();
+  {
+    const std::lock_guard lock(prefetchMutex);
+    stopPrefetch = true;
+  }
+  prefetchCv.notify_all();
+  if (prefetchThread.joinable())
+    prefetchThread.join();
   shutdownRender();
   SDL_Quit();
   return 0;
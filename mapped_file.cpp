@@ -0,0 +1,142 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "mapped_file.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+#ifdef _WIN32
+bool MappedFile::openRead(const char* path) {
+  file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  LARGE_INTEGER fileSize;
+  if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize)) {
+    file = nullptr;
+    std::cout << "Failed to open " << path << "!" << std::endl;
+    return false;
+  }
+  length = static_cast<uint64_t>(fileSize.QuadPart);
+  mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  base = mapping ? static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0)) : nullptr;
+  if (!base) {
+    std::cout << "Failed to map " << path << "!" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool MappedFile::create(const char* path, uint64_t size) {
+  file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    file = nullptr;
+    std::cout << "Failed to open " << path << " for writing!" << std::endl;
+    return false;
+  }
+  length = size;
+  writable = true;
+  LARGE_INTEGER end;
+  end.QuadPart = static_cast<LONGLONG>(size);
+  mapping = SetFilePointerEx(file, end, nullptr, FILE_BEGIN) && SetEndOfFile(file)
+                ? CreateFileMappingA(file, nullptr, PAGE_READWRITE, 0, 0, nullptr)
+                : nullptr;
+  base = mapping ? static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0)) : nullptr;
+  if (!base) {
+    std::cout << "Failed to map " << path << "!" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void MappedFile::flush(uint64_t offset, uint64_t size) {
+  // Already asynchronous, no page alignment needed
+  FlushViewOfFile(base + offset, static_cast<SIZE_T>(size));
+}
+
+bool MappedFile::close() {
+  bool ok = true;
+  if (base) {
+    if (writable)
+      ok = FlushViewOfFile(base, 0) && FlushFileBuffers(file);
+    UnmapViewOfFile(base);
+  }
+  if (mapping)
+    CloseHandle(mapping);
+  if (file)
+    CloseHandle(file);
+  base = nullptr;
+  mapping = nullptr;
+  file = nullptr;
+  return ok;
+}
+#else
+bool MappedFile::openRead(const char* path) {
+  fd = open(path, O_RDONLY);
+  struct stat info;
+  if (fd < 0 || fstat(fd, &info) != 0) {
+    std::cout << "Failed to open " << path << "!" << std::endl;
+    return false;
+  }
+  length = static_cast<uint64_t>(info.st_size);
+  void* map = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED) {
+    std::cout << "Failed to map " << path << "!" << std::endl;
+    return false;
+  }
+  base = static_cast<uint8_t*>(map);
+  return true;
+}
+
+bool MappedFile::create(const char* path, uint64_t size) {
+  fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0 || ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    std::cout << "Failed to open " << path << " for writing!" << std::endl;
+    return false;
+  }
+  length = size;
+  writable = true;
+  int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+  flags |= MAP_POPULATE;
+#endif
+  void* map = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, fd, 0);
+  if (map == MAP_FAILED) {
+    std::cout << "Failed to map " << path << "!" << std::endl;
+    return false;
+  }
+  base = static_cast<uint8_t*>(map);
+  return true;
+}
+
+void MappedFile::flush(uint64_t offset, uint64_t size) {
+  // msync wants a page aligned start
+  const uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+  const uint64_t start = offset & ~(page - 1);
+  msync(base + start, offset + size - start, MS_ASYNC);
+}
+
+bool MappedFile::close() {
+  bool ok = true;
+  if (base) {
+    if (writable)
+      ok = msync(base, length, MS_SYNC) == 0;
+    munmap(base, length);
+  }
+  if (fd >= 0)
+    ::close(fd);
+  base = nullptr;
+  fd = -1;
+  return ok;
+}
+#endif
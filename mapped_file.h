@@ -0,0 +1,44 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+
+// A whole file mapped into memory
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Existing file, mapped private (copy on write) so it can be detiled in place without touching the file
+  bool openRead(const char* path);
+  // New file of size bytes (ftruncate), shared so stores land in the page cache directly. The page cache
+  // pages are set up front (MAP_POPULATE), but populating a shared mapping only maps them read only: the
+  // first store to each page still takes a write fault, just a minor one that marks it dirty.
+  bool create(const char* path, uint64_t size);
+  // Starts writeback of a range (msync MS_ASYNC), called per batch so dirty pages don't pile up
+  void flush(uint64_t offset, uint64_t size);
+  // Waits for writeback (write maps) and unmaps
+  bool close();
+
+  uint8_t* data() const {
+    return base;
+  }
+
+  uint64_t size() const {
+    return length;
+  }
+
+private:
+  uint8_t* base = nullptr;
+  uint64_t length = 0;
+  bool writable = false;
+#ifdef _WIN32
+  void* file = nullptr;
+  void* mapping = nullptr;
+#else
+  int fd = -1;
+#endif
+};
@@ -0,0 +1,251 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "png.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t hashBits = 15;
+constexpr uint32_t maxDistance = 32768;
+constexpr uint32_t maxMatch = 258;
+
+constexpr uint16_t lengthBase[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                     31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr uint16_t distanceBase[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                       193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr uint8_t distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+uint32_t reverseBits(uint32_t code, uint32_t count) {
+  uint32_t out = 0;
+  for (uint32_t i = 0; i < count; i++)
+    out |= ((code >> i) & 1) << (count - 1 - i);
+  return out;
+}
+
+// The fixed Huffman codes of RFC 1951 3.2.6, bit reversed since deflate packs codes MSB first
+struct FixedCodes {
+  uint16_t literal[288];
+  uint8_t literalBits[288];
+  uint8_t distance[30];
+  uint8_t lengthSymbol[maxMatch + 1]; // Index into lengthBase
+
+  FixedCodes() {
+    for (uint32_t i = 0; i < 288; i++) {
+      uint32_t code, count;
+      if (i < 144) {
+        code = 0x30 + i;
+        count = 8;
+      } else if (i < 256) {
+        code = 0x190 + i - 144;
+        count = 9;
+      } else if (i < 280) {
+        code = i - 256;
+        count = 7;
+      } else {
+        code = 0xC0 + i - 280;
+        count = 8;
+      }
+      literal[i] = static_cast<uint16_t>(reverseBits(code, count));
+      literalBits[i] = static_cast<uint8_t>(count);
+    }
+    for (uint32_t i = 0; i < 30; i++)
+      distance[i] = static_cast<uint8_t>(reverseBits(i, 5));
+    for (uint32_t i = 0, length = 3; length <= maxMatch; length++) {
+      while (i < 28 && length >= lengthBase[i + 1])
+        i++;
+      lengthSymbol[length] = static_cast<uint8_t>(i);
+    }
+  }
+};
+
+const FixedCodes codes;
+
+struct CrcTable {
+  uint32_t entries[256];
+
+  CrcTable() {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++)
+        c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+      entries[i] = c;
+    }
+  }
+};
+
+const CrcTable crcTable;
+
+void putBE32(uint8_t* out, uint32_t value) {
+  out[0] = static_cast<uint8_t>(value >> 24);
+  out[1] = static_cast<uint8_t>(value >> 16);
+  out[2] = static_cast<uint8_t>(value >> 8);
+  out[3] = static_cast<uint8_t>(value);
+}
+
+uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+  const int p = a + b - c;
+  const int pa = std::abs(p - a);
+  const int pb = std::abs(p - b);
+  const int pc = std::abs(p - c);
+  if (pa <= pb && pa <= pc)
+    return a;
+  return pb <= pc ? b : c;
+}
+
+} // namespace
+
+uint32_t updateCrc32(uint32_t crc, const uint8_t* data, size_t size) {
+  crc = ~crc;
+  for (size_t i = 0; i < size; i++)
+    crc = crcTable.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+PngEncoder::PngEncoder(std::ostream& out, uint32_t width, uint32_t height)
+    : out(out), width(width), previous(static_cast<size_t>(width) * 4), hashTable(1u << hashBits) {
+  static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  out.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+  uint8_t ihdr[13];
+  putBE32(ihdr, width);
+  putBE32(ihdr + 4, height);
+  ihdr[8] = 8;  // Bit depth
+  ihdr[9] = 6;  // RGBA
+  ihdr[10] = 0; // Deflate
+  ihdr[11] = 0; // Adaptive filtering
+  ihdr[12] = 0; // No interlace
+  writeChunk("IHDR", ihdr, sizeof(ihdr));
+  // zlib header, 32K window, fastest
+  idat.push_back(0x78);
+  idat.push_back(0x01);
+}
+
+// Picks the filter with the smallest sum of absolute (signed) residuals, the usual PNG heuristic
+void PngEncoder::filterRow(const uint8_t* row) {
+  const size_t size = static_cast<size_t>(width) * 4;
+  uint32_t cost[4] = {};
+  for (size_t i = 0; i < size; i++) {
+    const uint8_t a = i >= 4 ? row[i - 4] : 0;
+    const uint8_t b = previous[i];
+    const uint8_t c = i >= 4 ? previous[i - 4] : 0;
+    cost[0] += std::abs(static_cast<int8_t>(row[i]));
+    cost[1] += std::abs(static_cast<int8_t>(row[i] - a));
+    cost[2] += std::abs(static_cast<int8_t>(row[i] - b));
+    cost[3] += std::abs(static_cast<int8_t>(row[i] - paeth(a, b, c)));
+  }
+  // None, Sub, Up, Paeth are filter types 0-3 here, type 3 (Average) is skipped
+  const uint32_t best = static_cast<uint32_t>(std::min_element(cost, cost + 4) - cost);
+  filtered.push_back(static_cast<uint8_t>(best == 3 ? 4 : best));
+  for (size_t i = 0; i < size; i++) {
+    const uint8_t a = i >= 4 ? row[i - 4] : 0;
+    const uint8_t b = previous[i];
+    const uint8_t c = i >= 4 ? previous[i - 4] : 0;
+    const uint8_t predicted = best == 0 ? 0 : best == 1 ? a : best == 2 ? b : paeth(a, b, c);
+    filtered.push_back(static_cast<uint8_t>(row[i] - predicted));
+  }
+  std::memcpy(previous.data(), row, size);
+}
+
+void PngEncoder::putBits(uint32_t value, uint32_t count) {
+  bits |= static_cast<uint64_t>(value) << bitCount;
+  bitCount += count;
+  while (bitCount >= 8) {
+    idat.push_back(static_cast<uint8_t>(bits));
+    bits >>= 8;
+    bitCount -= 8;
+  }
+}
+
+void PngEncoder::putSymbol(uint32_t symbol) {
+  putBits(codes.literal[symbol], codes.literalBits[symbol]);
+}
+
+void PngEncoder::deflateBlock(bool last) {
+  putBits(last ? 1 : 0, 1);
+  putBits(1, 2); // Fixed Huffman
+
+  const uint8_t* data = filtered.data();
+  const size_t size = filtered.size();
+  std::fill(hashTable.begin(), hashTable.end(), -1);
+  for (size_t i = 0; i < size;) {
+    if (i + 4 <= size) {
+      uint32_t word;
+      std::memcpy(&word, data + i, 4);
+      const uint32_t hash = (word * 2654435761u) >> (32 - hashBits);
+      const int32_t candidate = hashTable[hash];
+      hashTable[hash] = static_cast<int32_t>(i);
+      if (candidate >= 0 && i - candidate <= maxDistance && std::memcmp(data + candidate, data + i, 4) == 0) {
+        const size_t limit = std::min<size_t>(maxMatch, size - i);
+        uint32_t length = 4;
+        while (length < limit && data[candidate + length] == data[i + length])
+          length++;
+        const uint32_t distance = static_cast<uint32_t>(i - candidate);
+
+        const uint32_t lengthCode = codes.lengthSymbol[length];
+        putSymbol(257 + lengthCode);
+        putBits(length - lengthBase[lengthCode], lengthExtra[lengthCode]);
+        uint32_t distanceCode = 29;
+        while (distanceBase[distanceCode] > distance)
+          distanceCode--;
+        putBits(codes.distance[distanceCode], 5);
+        putBits(distance - distanceBase[distanceCode], distanceExtra[distanceCode]);
+        i += length;
+        continue;
+      }
+    }
+    putSymbol(data[i]);
+    i++;
+  }
+  putSymbol(256); // End of block
+
+  // Adler-32 of the uncompressed stream, reduced often enough not to overflow
+  for (size_t i = 0; i < size;) {
+    const size_t end = std::min(size, i + 5552);
+    for (; i < end; i++) {
+      adlerA += data[i];
+      adlerB += adlerA;
+    }
+    adlerA %= 65521;
+    adlerB %= 65521;
+  }
+}
+
+void PngEncoder::writeRows(const uint8_t* rgba, uint32_t count) {
+  filtered.clear();
+  for (uint32_t y = 0; y < count; y++)
+    filterRow(rgba + static_cast<size_t>(y) * width * 4);
+  deflateBlock(false);
+  writeChunk("IDAT", idat.data(), idat.size());
+  idat.clear();
+}
+
+void PngEncoder::finish() {
+  filtered.clear();
+  deflateBlock(true);
+  if (bitCount)
+    putBits(0, 8 - bitCount);
+  uint8_t adler[4];
+  putBE32(adler, adlerB << 16 | adlerA);
+  idat.insert(idat.end(), adler, adler + 4);
+  writeChunk("IDAT", idat.data(), idat.size());
+  idat.clear();
+  writeChunk("IEND", nullptr, 0);
+}
+
+void PngEncoder::writeChunk(const char* type, const uint8_t* data, size_t size) {
+  uint8_t header[8];
+  putBE32(header, static_cast<uint32_t>(size));
+  std::memcpy(header + 4, type, 4);
+  uint32_t crc = updateCrc32(0, header + 4, 4);
+  if (size)
+    crc = updateCrc32(crc, data, size);
+  uint8_t footer[4];
+  putBE32(footer, crc);
+  out.write(reinterpret_cast<const char*>(header), sizeof(header));
+  if (size)
+    out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+  out.write(reinterpret_cast<const char*>(footer), sizeof(footer));
+}
@@ -0,0 +1,41 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// CRC-32 (ISO 3309), the one PNG chunks and zip members use. crc is the running value, 0 to start.
+// Not called crc32 so it can't collide with zlib's when both are linked in.
+uint32_t updateCrc32(uint32_t crc, const uint8_t* data, size_t size);
+
+// Streaming RGBA8 PNG encoder. Every writeRows call filters and deflates its rows on the spot and
+// emits them as one IDAT chunk, so nothing but the previous row is kept between calls.
+// Deflate is fixed Huffman with a greedy single candidate LZ77, matches stay inside a call.
+class PngEncoder {
+public:
+  PngEncoder(std::ostream& out, uint32_t width, uint32_t height);
+
+  // count rows of width * 4 bytes, tightly packed
+  void writeRows(const uint8_t* rgba, uint32_t count);
+  void finish();
+
+private:
+  void filterRow(const uint8_t* row);
+  void deflateBlock(bool last);
+  void putBits(uint32_t value, uint32_t count);
+  void putSymbol(uint32_t symbol);
+  void writeChunk(const char* type, const uint8_t* data, size_t size);
+
+  std::ostream& out;
+  uint32_t width;
+  std::vector<uint8_t> previous; // Unfiltered, zeros above the first row
+  std::vector<uint8_t> filtered; // Filter type byte + filtered row, for the rows of this call
+  std::vector<int32_t> hashTable;
+  std::vector<uint8_t> idat;
+  uint64_t bits = 0;
+  uint32_t bitCount = 0;
+  uint32_t adlerA = 1;
+  uint32_t adlerB = 0;
+};
@@ -0,0 +1,89 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "qoi.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t opIndex = 0x00;
+constexpr uint8_t opDiff = 0x40;
+constexpr uint8_t opLuma = 0x80;
+constexpr uint8_t opRun = 0xC0;
+constexpr uint8_t opRGB = 0xFE;
+constexpr uint8_t opRGBA = 0xFF;
+
+void putBE32(uint8_t* out, uint32_t value) {
+  out[0] = static_cast<uint8_t>(value >> 24);
+  out[1] = static_cast<uint8_t>(value >> 16);
+  out[2] = static_cast<uint8_t>(value >> 8);
+  out[3] = static_cast<uint8_t>(value);
+}
+
+} // namespace
+
+QoiEncoder::QoiEncoder(std::ostream& out, uint32_t width, uint32_t height) : out(out), width(width) {
+  uint8_t header[14] = {'q', 'o', 'i', 'f'};
+  putBE32(header + 4, width);
+  putBE32(header + 8, height);
+  header[12] = 4; // RGBA
+  header[13] = 0; // sRGB with linear alpha
+  out.write(reinterpret_cast<const char*>(header), sizeof(header));
+}
+
+void QoiEncoder::flushRun() {
+  if (run) {
+    bytes.push_back(static_cast<uint8_t>(opRun | (run - 1)));
+    run = 0;
+  }
+}
+
+void QoiEncoder::writeRows(const uint8_t* rgba, uint32_t count) {
+  const size_t pixels = static_cast<size_t>(width) * count;
+  bytes.clear();
+  bytes.reserve(pixels * 5 / 4);
+  for (size_t i = 0; i < pixels; i++) {
+    const uint8_t* px = rgba + i * 4;
+    if (std::memcmp(px, prev, 4) == 0) {
+      // Runs are 1-62, the two values above would collide with opRGB/opRGBA
+      if (++run == 62)
+        flushRun();
+      continue;
+    }
+    flushRun();
+
+    const uint32_t hash = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+    if (std::memcmp(index[hash], px, 4) == 0) {
+      bytes.push_back(static_cast<uint8_t>(opIndex | hash));
+    } else {
+      std::memcpy(index[hash], px, 4);
+      if (px[3] == prev[3]) {
+        const int8_t dr = static_cast<int8_t>(px[0] - prev[0]);
+        const int8_t dg = static_cast<int8_t>(px[1] - prev[1]);
+        const int8_t db = static_cast<int8_t>(px[2] - prev[2]);
+        const int drdg = dr - dg;
+        const int dbdg = db - dg;
+        if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+          bytes.push_back(static_cast<uint8_t>(opDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+        } else if (dg >= -32 && dg <= 31 && drdg >= -8 && drdg <= 7 && dbdg >= -8 && dbdg <= 7) {
+          bytes.push_back(static_cast<uint8_t>(opLuma | (dg + 32)));
+          bytes.push_back(static_cast<uint8_t>((drdg + 8) << 4 | (dbdg + 8)));
+        } else {
+          bytes.insert(bytes.end(), {opRGB, px[0], px[1], px[2]});
+        }
+      } else {
+        bytes.insert(bytes.end(), {opRGBA, px[0], px[1], px[2], px[3]});
+      }
+    }
+    std::memcpy(prev, px, 4);
+  }
+  out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+void QoiEncoder::finish() {
+  bytes.clear();
+  flushRun();
+  static const uint8_t end[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+  bytes.insert(bytes.end(), end, end + 8);
+  out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
@@ -0,0 +1,28 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Streaming RGBA8 QOI encoder (qoiformat.org spec 1.0), the whole state is the previous pixel,
+// the 64 entry index and the current run so rows can be fed in any batches.
+class QoiEncoder {
+public:
+  QoiEncoder(std::ostream& out, uint32_t width, uint32_t height);
+
+  // count rows of width * 4 bytes, tightly packed
+  void writeRows(const uint8_t* rgba, uint32_t count);
+  void finish();
+
+private:
+  void flushRun();
+
+  std::ostream& out;
+  uint32_t width;
+  uint8_t index[64][4] = {};
+  uint8_t prev[4] = {0, 0, 0, 255};
+  uint32_t run = 0;
+  std::vector<uint8_t> bytes;
+};
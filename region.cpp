@@ -0,0 +1,121 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "region.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <climits>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+// Tile rows closer than this in the file are read in one go, on network storage a round trip
+// costs more than the bytes in between
+constexpr uint64_t maxReadGap = 64 * 1024;
+
+bool parseRegion(const char* text, Region& region) {
+  return std::sscanf(text, "%u,%u,%ux%u", &region.x, &region.y, &region.width, &region.height) == 4 &&
+         region.width && region.height;
+}
+
+RegionTiles regionTiles(SurfaceFormat format, const Region& region) {
+  // Tiles are 32 blocks wide for BCn
+  const uint32_t tileSize = isBlockCompressed(format) ? 32 * 4 : 32;
+  RegionTiles tiles;
+  tiles.tileX = region.x / tileSize;
+  tiles.tileY = region.y / tileSize;
+  tiles.tilesX = (region.x + region.width + tileSize - 1) / tileSize - tiles.tileX;
+  tiles.tilesY = (region.y + region.height + tileSize - 1) / tileSize - tiles.tileY;
+  tiles.width = tiles.tilesX * tileSize;
+  tiles.height = tiles.tilesY * tileSize;
+  tiles.offsetX = region.x - tiles.tileX * tileSize;
+  tiles.offsetY = region.y - tiles.tileY * tileSize;
+  return tiles;
+}
+
+// A row of the region's tiles, contiguous in the file and in dst
+struct TileRun {
+  uint64_t fileOffset;
+  uint8_t* dst;
+  size_t size;
+};
+
+#ifndef _WIN32
+// preadv until every iovec is full, it can stop short like read()
+static bool preadAll(int fd, iovec* iov, int count, uint64_t offset) {
+  while (count > 0) {
+    const ssize_t n = preadv(fd, iov, std::min(count, IOV_MAX), static_cast<off_t>(offset));
+    if (n <= 0)
+      return false;
+    offset += n;
+    size_t done = static_cast<size_t>(n);
+    while (count > 0 && done >= iov->iov_len) {
+      done -= iov->iov_len;
+      iov++;
+      count--;
+    }
+    if (count > 0) {
+      iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + done;
+      iov->iov_len -= done;
+    }
+  }
+  return true;
+}
+
+static bool readRuns(const char* path, const std::vector<TileRun>& runs) {
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  std::vector<uint8_t> gap(maxReadGap);
+  std::vector<iovec> iov;
+  bool ok = true;
+  for (size_t i = 0; i < runs.size() && ok;) {
+    // Runs with small gaps between them become one preadv, the gaps all land in the same scratch buffer
+    const uint64_t start = runs[i].fileOffset;
+    iov.clear();
+    iov.push_back({runs[i].dst, runs[i].size});
+    uint64_t end = start + runs[i].size;
+    for (i++; i < runs.size() && runs[i].fileOffset - end <= maxReadGap; i++) {
+      if (runs[i].fileOffset != end)
+        iov.push_back({gap.data(), static_cast<size_t>(runs[i].fileOffset - end)});
+      iov.push_back({runs[i].dst, runs[i].size});
+      end = runs[i].fileOffset + runs[i].size;
+    }
+    ok = preadAll(fd, iov.data(), static_cast<int>(iov.size()), start);
+  }
+  close(fd);
+  return ok;
+}
+#else
+static bool readRuns(const char* path, const std::vector<TileRun>& runs) {
+  std::ifstream f(path, std::ios::in | std::ios::binary);
+  for (const TileRun& run : runs) {
+    f.seekg(static_cast<std::streamoff>(run.fileOffset));
+    f.read(reinterpret_cast<char*>(run.dst), static_cast<std::streamsize>(run.size));
+  }
+  return f.good();
+}
+#endif
+
+bool readRegionTiles(const char* path, SurfaceFormat format, uint32_t surfaceWidth, const RegionTiles& tiles,
+                     uint8_t* dst) {
+  const uint64_t tileSize = 1024 * bytesPerBlock(format);
+  const uint64_t rowSize = tiledRowSize(format, surfaceWidth);
+  std::vector<TileRun> runs;
+  for (uint32_t row = 0; row < tiles.tilesY; row++) {
+    const size_t size = tiles.tilesX * tileSize;
+    runs.push_back({(tiles.tileY + row) * rowSize + tiles.tileX * tileSize, dst + row * size, size});
+  }
+  if (!readRuns(path, runs)) {
+    std::cout << "Failed to read the region from " << path << "!" << std::endl;
+    return false;
+  }
+  return true;
+}
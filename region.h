@@ -0,0 +1,40 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+
+#include "xenos.h"
+
+// A rectangle of a surface, in pixels
+struct Region {
+  uint32_t x = 0;
+  uint32_t y = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+};
+
+// The 32x32 tiles (of blocks for BCn) a region touches. What's inside a tile only depends on the position
+// in the tile, so these tiles make a tiled surface of their own: width x height pixels, tiled the same way.
+struct RegionTiles {
+  uint32_t tileX;
+  uint32_t tileY;
+  uint32_t tilesX;
+  uint32_t tilesY;
+  uint32_t width;  // Of the tile surface, in pixels
+  uint32_t height;
+  uint32_t offsetX; // Where the region starts in it
+  uint32_t offsetY;
+};
+
+// "X,Y,WxH"
+bool parseRegion(const char* text, Region& region);
+
+// region has to be inside the surface already
+RegionTiles regionTiles(SurfaceFormat format, const Region& region);
+
+// Reads only the tiles of a region from a dump of a surfaceWidth wide surface, into dst
+// (tiledSurfaceSize(format, tiles.width, tiles.height) bytes). Tile rows that are close together in the
+// file are coalesced into one read, the gap between them is read into a scratch buffer and dropped.
+bool readRegionTiles(const char* path, SurfaceFormat format, uint32_t surfaceWidth, const RegionTiles& tiles,
+                     uint8_t* dst);
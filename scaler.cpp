@@ -0,0 +1,51 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "scaler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numbers>
+
+bool parseOutputMode(const std::string& mode, ScalerConfig& config) {
+  if (mode == "480p") {
+    config.outputWidth = 640;
+    config.outputHeight = 480;
+  } else if (mode == "720p") {
+    config.outputWidth = 1280;
+    config.outputHeight = 720;
+  } else if (mode == "1080p") {
+    config.outputWidth = 1920;
+    config.outputHeight = 1080;
+  } else if (std::sscanf(mode.c_str(), "%ux%u", &config.outputWidth, &config.outputHeight) != 2 ||
+             !config.outputWidth || !config.outputHeight) {
+    return false;
+  }
+  return true;
+}
+
+static double sinc(double x) {
+  if (x == 0.0)
+    return 1.0;
+  x *= std::numbers::pi;
+  return std::sin(x) / x;
+}
+
+std::vector<float> polyphaseCoefficients(uint32_t taps, uint32_t phases, uint32_t srcSize, uint32_t dstSize) {
+  const double lobes = taps / 2.0;
+  const double stretch = std::max(1.0, static_cast<double>(srcSize) / dstSize);
+  std::vector<float> coefficients(phases * taps);
+  for (uint32_t p = 0; p < phases; p++) {
+    const double frac = static_cast<double>(p) / phases;
+    double sum = 0.0;
+    double weights[16] = {};
+    for (uint32_t t = 0; t < taps; t++) {
+      const double x = (static_cast<double>(t) - (taps / 2 - 1) - frac) / stretch;
+      weights[t] = std::abs(x) < lobes ? sinc(x) * sinc(x / lobes) : 0.0;
+      sum += weights[t];
+    }
+    for (uint32_t t = 0; t < taps; t++)
+      coefficients[p * taps + t] = static_cast<float>(weights[t] / sum);
+  }
+  return coefficients;
+}
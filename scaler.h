@@ -0,0 +1,31 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Polyphase scaler setup, mirrors the console's display scaler:
+// a fixed number of taps per direction and a bank of precomputed phases
+struct ScalerConfig {
+  uint32_t outputWidth = 0;
+  uint32_t outputHeight = 0;
+  uint32_t taps = 4;
+  uint32_t phases = 64;
+};
+
+// Filter used to bring the final image up to the window size
+enum class PresentFilter : uint8_t {
+  Nearest, // Whatever the fullscreen triangle samples
+  Bicubic, // Catmull-Rom
+  Lanczos3,
+};
+
+// Output modes, "480p", "720p", "1080p" or WxH
+bool parseOutputMode(const std::string& mode, ScalerConfig& config);
+
+// phases * taps Lanczos weights, every phase normalized to 1.
+// Tap t of phase p sits at t - (taps / 2 - 1) - p / phases source texels from the sample point.
+// When downscaling the kernel is widened by src / dst (as far as the taps reach).
+std::vector<float> polyphaseCoefficients(uint32_t taps, uint32_t phases, uint32_t srcSize, uint32_t dstSize);
@@ -0,0 +1,136 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "shader_variants.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+uint64_t fnv1a(uint64_t hash, const std::string& text) {
+  for (const char c : text) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001B3;
+  }
+  return hash;
+}
+
+bool linked(GLuint program) {
+  GLint status = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &status);
+  return status == GL_TRUE;
+}
+
+} // namespace
+
+void ShaderVariants::setCacheDirectory(std::string directory) {
+  cacheDirectory = std::move(directory);
+  if (cacheDirectory.empty())
+    return;
+  std::error_code error;
+  std::filesystem::create_directories(cacheDirectory, error);
+  if (error) {
+    std::cout << "Can't use " << cacheDirectory << " as shader cache: " << error.message() << std::endl;
+    cacheDirectory.clear();
+  }
+}
+
+GLuint ShaderVariants::get(const char* source, const std::string& defines) {
+  const auto key = std::make_pair(source, defines);
+  const auto found = programs.find(key);
+  if (found != programs.end())
+    return found->second;
+
+  // The defines go right after #version, nothing else may come before it
+  std::string text = source;
+  const size_t version = text.find("#version");
+  const size_t lineEnd = version == std::string::npos ? 0 : text.find('\n', version) + 1;
+  text.insert(lineEnd, defines);
+
+  const GLuint program = build(text);
+  programs.emplace(key, program);
+  return program;
+}
+
+GLuint ShaderVariants::build(const std::string& text) {
+  GLuint program = glCreateProgram();
+  std::string binaryPath;
+  if (!cacheDirectory.empty()) {
+    // Binaries only load on the driver that made them
+    uint64_t hash = 0xCBF29CE484222325;
+    hash = fnv1a(hash, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    hash = fnv1a(hash, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    hash = fnv1a(hash, text);
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(hash));
+    binaryPath = (std::filesystem::path(cacheDirectory) / name).string();
+    if (loadBinary(program, binaryPath))
+      return program;
+  }
+
+  const GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+  const char* source = text.c_str();
+  glShaderSource(shader, 1, &source, nullptr);
+  glCompileShader(shader);
+  GLint compiled = GL_FALSE;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+  if (!compiled) {
+    char infoLog[512];
+    glGetShaderInfoLog(shader, sizeof(infoLog), nullptr, infoLog);
+    std::cout << "Shader Compilation Error:\n" << infoLog << std::endl;
+    glDeleteShader(shader);
+    glDeleteProgram(program);
+    return 0;
+  }
+  if (!binaryPath.empty())
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  glAttachShader(program, shader);
+  glLinkProgram(program);
+  glDeleteShader(shader);
+  if (!linked(program)) {
+    char infoLog[512];
+    glGetProgramInfoLog(program, sizeof(infoLog), nullptr, infoLog);
+    std::cout << "Shader Linking Error:\n" << infoLog << std::endl;
+    glDeleteProgram(program);
+    return 0;
+  }
+  if (!binaryPath.empty())
+    saveBinary(program, binaryPath);
+  return program;
+}
+
+// A cached binary is its GLenum format followed by the blob. Stale ones (driver update) fail to link
+// and the variant is compiled again, overwriting them.
+bool ShaderVariants::loadBinary(GLuint program, const std::string& path) {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  uint32_t format;
+  if (!file.read(reinterpret_cast<char*>(&format), sizeof(format)))
+    return false;
+  const std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+  return linked(program);
+}
+
+void ShaderVariants::saveBinary(GLuint program, const std::string& path) {
+  GLint size = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+  if (size <= 0)
+    return; // Driver has no binary formats
+  std::vector<char> binary(size);
+  GLenum format = 0;
+  glGetProgramBinary(program, size, nullptr, &format, binary.data());
+  std::ofstream file(path, std::ios::out | std::ios::binary);
+  const uint32_t format32 = format;
+  file.write(reinterpret_cast<const char*>(&format32), sizeof(format32));
+  file.write(binary.data(), size);
+}
+
+void ShaderVariants::clear() {
+  for (const auto& [key, program] : programs)
+    glDeleteProgram(program);
+  programs.clear();
+}
@@ -0,0 +1,33 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include <KHR/khrplatform.h>
+#include <glad/glad.h>
+
+// Specialized builds of an uber compute kernel. A variant is the kernel's GLSL with a block of #defines injected
+// right after its #version line, compiled the first time that define set is asked for and kept for the rest
+// of the run, so every dispatch runs code with its whole configuration folded in instead of branching on
+// uniforms. With a cache directory the linked programs are also saved as program binaries, keyed by the
+// driver and the full source, and later runs load those instead of compiling.
+class ShaderVariants {
+public:
+  // Empty to keep variants in memory only
+  void setCacheDirectory(std::string directory);
+  // defines is "#define NAME VALUE" lines. 0 if the variant doesn't compile or link.
+  GLuint get(const char* source, const std::string& defines);
+  // Deletes every program, needs the context
+  void clear();
+
+private:
+  GLuint build(const std::string& text);
+  bool loadBinary(GLuint program, const std::string& path);
+  void saveBinary(GLuint program, const std::string& path);
+
+  std::map<std::pair<const char*, std::string>, GLuint> programs;
+  std::string cacheDirectory;
+};
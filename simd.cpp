@@ -0,0 +1,93 @@
+// Copyright 2025 Xenon Emulator Project
+
+#include "simd.h"
+#include "bc_block.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef XE_ARCH_X64
+#include <immintrin.h>
+#endif
+#ifdef XE_ARCH_ARM64
+#include <arm_neon.h>
+#endif
+
+// Every function defined between these gets the target, like XE_TARGET on each of them.
+// Header inlines (xeTiledOffset2D, the BC palette code) stay baseline and inline into the kernels.
+#define XE_STRINGIFY(x) #x
+#if defined(_MSC_VER) && !defined(__clang__)
+#define XE_BEGIN_TARGET(x)
+#define XE_END_TARGET
+#elif defined(__clang__)
+#define XE_BEGIN_TARGET(x) _Pragma(XE_STRINGIFY(clang attribute push(__attribute__((target(x))), apply_to = function)))
+#define XE_END_TARGET _Pragma("clang attribute pop")
+#else
+#define XE_BEGIN_TARGET(x) _Pragma("GCC push_options") _Pragma(XE_STRINGIFY(GCC target(x)))
+#define XE_END_TARGET _Pragma("GCC pop_options")
+#endif
+
+#ifdef XE_ARCH_X64
+// Baseline on x64, no target needed
+#define XE_SIMD_SSE2
+namespace simd_sse2 {
+#include "simd_ops.inl"
+#include "simd_kernels.inl"
+} // namespace simd_sse2
+#undef XE_SIMD_SSE2
+
+#define XE_SIMD_AVX2
+XE_BEGIN_TARGET("avx2")
+namespace simd_avx2 {
+#include "simd_ops.inl"
+#include "simd_kernels.inl"
+} // namespace simd_avx2
+XE_END_TARGET
+#undef XE_SIMD_AVX2
+
+// GCC 12's AVX-512 headers trip -Wmaybe-uninitialized on their own _mm512_undefined_epi32()
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#define XE_SIMD_AVX512
+XE_BEGIN_TARGET("avx512f")
+namespace simd_avx512 {
+#include "simd_ops.inl"
+#include "simd_kernels.inl"
+} // namespace simd_avx512
+XE_END_TARGET
+#undef XE_SIMD_AVX512
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+#ifdef XE_ARCH_ARM64
+// Baseline on arm64 too
+#define XE_SIMD_NEON
+namespace simd_neon {
+#include "simd_ops.inl"
+#include "simd_kernels.inl"
+} // namespace simd_neon
+#undef XE_SIMD_NEON
+#endif
+
+const SimdKernels* simdKernels(CpuBackend backend) {
+  switch (backend) {
+#ifdef XE_ARCH_X64
+  case CpuBackend::SSE2:
+    return &simd_sse2::kernels;
+  case CpuBackend::AVX2:
+    return &simd_avx2::kernels;
+  case CpuBackend::AVX512:
+    return &simd_avx512::kernels;
+#endif
+#ifdef XE_ARCH_ARM64
+  case CpuBackend::NEON:
+    return &simd_neon::kernels;
+#endif
+  default:
+    return nullptr;
+  }
+}
@@ -0,0 +1,20 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+
+#include "cpu.h"
+#include "xenos.h"
+
+// The SIMD kernels are written once against the small vector layer in simd_ops.inl and built for
+// every target of the architecture (SSE2/AVX2/AVX-512 on x64, NEON on arm64) in the same binary.
+struct SimdKernels {
+  // Same contracts as detileFramebuffer (detile.h) and detileDecodeBC (bc.h)
+  void (*detileFramebuffer)(const uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height);
+  void (*detileDecodeBC)(const uint8_t* src, uint32_t* dst, uint32_t width, uint32_t height, SurfaceFormat format,
+                         bool swap);
+};
+
+// Kernels for a backend, nullptr for Scalar and for targets of another architecture
+const SimdKernels* simdKernels(CpuBackend backend);
@@ -0,0 +1,109 @@
+// Copyright 2025 Xenon Emulator Project
+
+// Kernels on top of simd_ops.inl, included once per target by simd.cpp (no include guard).
+
+// Framebuffer detile on row pairs. Rows 2n and 2n + 1 of a tile are 64 contiguous words,
+// eight 8 word slots each holding 4 pixels of the even row then 4 of the odd row.
+// Slot s has pixel group s ^ 4 on rows with y & 8, which swaps the 32 word halves of the pair.
+// Two loads cover kLanes / 4 slots, uninterleaving their blocks gives kLanes pixels of each row.
+static void detileFramebuffer(const uint32_t* src, uint32_t* dst, uint32_t width, uint32_t height) {
+  constexpr uint32_t groups = kLanes / 4; // 4 pixel groups per vector
+  const uint32_t tiledWidth = TILE(width);
+  const uint32_t tiles = (width + 31) / 32;
+  for (uint32_t y = 0; y < height; y += 2) {
+    const bool hasOdd = y + 1 < height;
+    uint32_t* even = dst + static_cast<uint64_t>(y) * width;
+    uint32_t* odd = even + width;
+    const uint32_t flip = (y & 8) ? 1 : 0;
+    for (uint32_t tx = 0; tx < tiles; tx++) {
+      const uint32_t* pair = src + static_cast<uint64_t>(y & ~31u) * tiledWidth + tx * 1024 + (y & 30) * 32;
+      const uint32_t x = tx * 32;
+      const uint32_t remaining = std::min(32u, width - x);
+      for (uint32_t half = 0; half < 2; half++) {
+        const uint32_t* halfSrc = pair + (half ^ flip) * 32;
+        for (uint32_t g = 0; g < 4; g += groups) {
+          const uint32_t px = half * 16 + g * 4;
+          if (px >= remaining)
+            break;
+          Vec e, o;
+          uninterleaveBlocks(load(halfSrc + g * 8), load(halfSrc + g * 8 + kLanes), e, o);
+          const uint32_t count = std::min(kLanes, remaining - px);
+          if (count == kLanes) {
+            store(even + x + px, e);
+            if (hasOdd)
+              store(odd + x + px, o);
+          } else {
+            storePartial(even + x + px, e, count);
+            if (hasOdd)
+              storePartial(odd + x + px, o, count);
+          }
+        }
+      }
+    }
+  }
+}
+
+// Full 4x4 BC block, kLanes texels (kLanes / 4 block rows) per vector. The indices are unpacked
+// up front so every target only needs table lookups, no per lane shifts.
+static void decodeFullBlock(const BlockPalette& pal, SurfaceFormat format, uint32_t* dst, uint32_t pitch) {
+  uint32_t colorIdx[16], alphaIdx[16], greenIdx[16];
+  unpackIndices(pal, format, colorIdx, alphaIdx, greenIdx);
+  // Channel palettes already shifted into place
+  uint32_t alphaTable[8], greenTable[8];
+  for (uint32_t i = 0; i < 8; i++) {
+    alphaTable[i] = static_cast<uint32_t>(pal.alpha[i]) << (format == SurfaceFormat::k_DXN ? 16 : 24);
+    greenTable[i] = static_cast<uint32_t>(pal.green[i]) << 8;
+  }
+
+  const Vec rgbMask = set1(0x00FFFFFF);
+  for (uint32_t t = 0; t < 16; t += kLanes) {
+    Vec texels;
+    switch (format) {
+    case SurfaceFormat::k_DXT2_3: {
+      const Vec alpha = load(alphaIdx + t);
+      texels = orv(andv(lookup4(pal.color, load(colorIdx + t)), rgbMask), shl<24>(orv(shl<4>(alpha), alpha)));
+      break;
+    }
+    case SurfaceFormat::k_DXT4_5:
+      texels = orv(andv(lookup4(pal.color, load(colorIdx + t)), rgbMask), lookup8(alphaTable, load(alphaIdx + t)));
+      break;
+    case SurfaceFormat::k_DXN:
+      texels = orv(set1(0xFF000000),
+                   orv(lookup8(alphaTable, load(alphaIdx + t)), lookup8(greenTable, load(greenIdx + t))));
+      break;
+    default:
+      texels = lookup4(pal.color, load(colorIdx + t));
+      break;
+    }
+    for (uint32_t block = 0; block < kLanes / 4; block++)
+      storeBlock(dst + (t / 4 + block) * pitch, texels, block);
+  }
+}
+
+static void detileDecodeBC(const uint8_t* src, uint32_t* dst, uint32_t width, uint32_t height, SurfaceFormat format,
+                           bool swap) {
+  const uint32_t blockSize = bytesPerBlock(format);
+  const uint32_t logBpb = blockSize == 8 ? 3 : 4;
+  const uint32_t blocksX = (width + 3) / 4;
+  const uint32_t blocksY = (height + 3) / 4;
+
+  uint8_t block[16];
+  BlockPalette pal{};
+  for (uint32_t by = 0; by < blocksY; by++) {
+    for (uint32_t bx = 0; bx < blocksX; bx++) {
+      const uint32_t offset = xeTiledOffset2D(bx, by, blocksX, logBpb);
+      loadBlock(src + static_cast<uint64_t>(offset) * blockSize, blockSize, swap, block);
+      buildPalette(block, format, pal);
+
+      uint32_t* out = dst + static_cast<uint64_t>(by) * 4 * width + bx * 4;
+      const uint32_t w = std::min(4u, width - bx * 4);
+      const uint32_t h = std::min(4u, height - by * 4);
+      if (w == 4 && h == 4)
+        decodeFullBlock(pal, format, out, width);
+      else
+        decodeBlock(pal, format, out, width, w, h);
+    }
+  }
+}
+
+static const SimdKernels kernels = {detileFramebuffer, detileDecodeBC};
@@ -0,0 +1,247 @@
+// Copyright 2025 Xenon Emulator Project
+
+// Vector layer for the SIMD kernels. No include guard on purpose: simd.cpp includes this once per
+// target, inside that target's namespace, with exactly one of the XE_SIMD_* macros defined.
+// Vec is a full register of kLanes 32 bit lanes, seen as kLanes / 4 blocks of 128 bits.
+//
+//   load/store/storePartial  unaligned, storePartial writes the first count lanes
+//   uninterleaveBlocks       a = {b0 b1 b2 b3 ...}, b = {...} -> even blocks of a:b, odd blocks of a:b
+//   lookup4/lookup8          per lane table[idx], idx < 4 / < 8
+//   storeBlock               stores 128 bit block i of v
+
+#if defined(XE_SIMD_SSE2)
+
+constexpr uint32_t kLanes = 4;
+using Vec = __m128i;
+
+static Vec load(const uint32_t* p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+static void store(uint32_t* p, Vec v) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+}
+
+static Vec set1(uint32_t x) {
+  return _mm_set1_epi32(static_cast<int>(x));
+}
+
+static Vec andv(Vec a, Vec b) {
+  return _mm_and_si128(a, b);
+}
+
+static Vec orv(Vec a, Vec b) {
+  return _mm_or_si128(a, b);
+}
+
+template <int N>
+static Vec shl(Vec v) {
+  return _mm_slli_epi32(v, N);
+}
+
+static void uninterleaveBlocks(Vec a, Vec b, Vec& even, Vec& odd) {
+  even = a;
+  odd = b;
+}
+
+// No variable permutes before SSSE3/AVX2, a compare + select per table entry
+static Vec lookup4(const uint32_t* table, Vec idx) {
+  Vec out = _mm_setzero_si128();
+  for (uint32_t i = 0; i < 4; i++)
+    out = orv(out, andv(_mm_cmpeq_epi32(idx, set1(i)), set1(table[i])));
+  return out;
+}
+
+static Vec lookup8(const uint32_t* table, Vec idx) {
+  Vec out = _mm_setzero_si128();
+  for (uint32_t i = 0; i < 8; i++)
+    out = orv(out, andv(_mm_cmpeq_epi32(idx, set1(i)), set1(table[i])));
+  return out;
+}
+
+static void storeBlock(uint32_t* p, Vec v, uint32_t) {
+  store(p, v);
+}
+
+#elif defined(XE_SIMD_AVX2)
+
+constexpr uint32_t kLanes = 8;
+using Vec = __m256i;
+
+static Vec load(const uint32_t* p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+static void store(uint32_t* p, Vec v) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+}
+
+static Vec set1(uint32_t x) {
+  return _mm256_set1_epi32(static_cast<int>(x));
+}
+
+static Vec andv(Vec a, Vec b) {
+  return _mm256_and_si256(a, b);
+}
+
+static Vec orv(Vec a, Vec b) {
+  return _mm256_or_si256(a, b);
+}
+
+template <int N>
+static Vec shl(Vec v) {
+  return _mm256_slli_epi32(v, N);
+}
+
+static void uninterleaveBlocks(Vec a, Vec b, Vec& even, Vec& odd) {
+  even = _mm256_permute2x128_si256(a, b, 0x20);
+  odd = _mm256_permute2x128_si256(a, b, 0x31);
+}
+
+static Vec lookup4(const uint32_t* table, Vec idx) {
+  return _mm256_permutevar8x32_epi32(_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table))),
+                                     idx);
+}
+
+static Vec lookup8(const uint32_t* table, Vec idx) {
+  return _mm256_permutevar8x32_epi32(load(table), idx);
+}
+
+static void storeBlock(uint32_t* p, Vec v, uint32_t block) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), block ? _mm256_extracti128_si256(v, 1) : _mm256_castsi256_si128(v));
+}
+
+#elif defined(XE_SIMD_AVX512)
+
+constexpr uint32_t kLanes = 16;
+using Vec = __m512i;
+
+static Vec load(const uint32_t* p) {
+  return _mm512_loadu_si512(p);
+}
+
+static void store(uint32_t* p, Vec v) {
+  _mm512_storeu_si512(p, v);
+}
+
+// Masked, nothing falls back to scalar on partial tiles
+static void storePartial(uint32_t* p, Vec v, uint32_t count) {
+  _mm512_mask_storeu_epi32(p, static_cast<__mmask16>((1u << count) - 1), v);
+}
+
+static Vec set1(uint32_t x) {
+  return _mm512_set1_epi32(static_cast<int>(x));
+}
+
+static Vec andv(Vec a, Vec b) {
+  return _mm512_and_si512(a, b);
+}
+
+static Vec orv(Vec a, Vec b) {
+  return _mm512_or_si512(a, b);
+}
+
+template <int N>
+static Vec shl(Vec v) {
+  return _mm512_slli_epi32(v, N);
+}
+
+// One vpermt2d per output, +4 picks the odd blocks
+static void uninterleaveBlocks(Vec a, Vec b, Vec& even, Vec& odd) {
+  const __m512i evenIndex = _mm512_setr_epi32(0, 1, 2, 3, 8, 9, 10, 11, 16, 17, 18, 19, 24, 25, 26, 27);
+  even = _mm512_permutex2var_epi32(a, evenIndex, b);
+  odd = _mm512_permutex2var_epi32(a, _mm512_add_epi32(evenIndex, _mm512_set1_epi32(4)), b);
+}
+
+static Vec lookup4(const uint32_t* table, Vec idx) {
+  return _mm512_permutexvar_epi32(idx, _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table))));
+}
+
+static Vec lookup8(const uint32_t* table, Vec idx) {
+  return _mm512_permutexvar_epi32(idx,
+                                  _mm512_broadcast_i64x4(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(table))));
+}
+
+static void storeBlock(uint32_t* p, Vec v, uint32_t block) {
+  __m128i out;
+  switch (block) {
+  case 0:
+    out = _mm512_castsi512_si128(v);
+    break;
+  case 1:
+    out = _mm512_extracti32x4_epi32(v, 1);
+    break;
+  case 2:
+    out = _mm512_extracti32x4_epi32(v, 2);
+    break;
+  default:
+    out = _mm512_extracti32x4_epi32(v, 3);
+    break;
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), out);
+}
+
+#elif defined(XE_SIMD_NEON)
+
+constexpr uint32_t kLanes = 4;
+using Vec = uint32x4_t;
+
+static Vec load(const uint32_t* p) {
+  return vld1q_u32(p);
+}
+
+static void store(uint32_t* p, Vec v) {
+  vst1q_u32(p, v);
+}
+
+static Vec set1(uint32_t x) {
+  return vdupq_n_u32(x);
+}
+
+static Vec andv(Vec a, Vec b) {
+  return vandq_u32(a, b);
+}
+
+static Vec orv(Vec a, Vec b) {
+  return vorrq_u32(a, b);
+}
+
+template <int N>
+static Vec shl(Vec v) {
+  return vshlq_n_u32(v, N);
+}
+
+static void uninterleaveBlocks(Vec a, Vec b, Vec& even, Vec& odd) {
+  even = a;
+  odd = b;
+}
+
+// Byte table lookups, lane index i becomes byte indices 4i..4i+3
+static uint8x16_t byteIndices(Vec idx) {
+  return vreinterpretq_u8_u32(vmlaq_n_u32(vdupq_n_u32(0x03020100), idx, 0x04040404));
+}
+
+static Vec lookup4(const uint32_t* table, Vec idx) {
+  return vreinterpretq_u32_u8(vqtbl1q_u8(vreinterpretq_u8_u32(vld1q_u32(table)), byteIndices(idx)));
+}
+
+static Vec lookup8(const uint32_t* table, Vec idx) {
+  const uint8x16x2_t bytes = {{vreinterpretq_u8_u32(vld1q_u32(table)), vreinterpretq_u8_u32(vld1q_u32(table + 4))}};
+  return vreinterpretq_u32_u8(vqtbl2q_u8(bytes, byteIndices(idx)));
+}
+
+static void storeBlock(uint32_t* p, Vec v, uint32_t) {
+  store(p, v);
+}
+
+#else
+#error "simd_ops.inl needs one of the XE_SIMD_* targets"
+#endif
+
+#if !defined(XE_SIMD_AVX512)
+static void storePartial(uint32_t* p, Vec v, uint32_t count) {
+  uint32_t lanes[kLanes];
+  store(lanes, v);
+  std::memcpy(p, lanes, count * sizeof(uint32_t));
+}
+#endif
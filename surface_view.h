@@ -0,0 +1,182 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <span>
+
+#include "xenos.h"
+
+// Lazy view over a tiled 32bpp surface (framebuffer layout, see xeFbConvert).
+// pixels(), rows() and tiles() walk the tiled data in linear order without making a linear copy,
+// the tiled address is carried along as the iterators advance instead of being recomputed per pixel.
+class TiledSurfaceView {
+public:
+  TiledSurfaceView(const uint32_t* data, uint32_t width, uint32_t height)
+      : data(data), tiledWidth(TILE(width)), originX(0), originY(0), width(width), height(height) {}
+
+  // Same data, limited to a rectangle (in pixels, relative to this view)
+  TiledSurfaceView crop(uint32_t x, uint32_t y, uint32_t w, uint32_t h) const {
+    TiledSurfaceView view = *this;
+    view.originX += x;
+    view.originY += y;
+    view.width = w;
+    view.height = h;
+    return view;
+  }
+
+  uint32_t getWidth() const {
+    return width;
+  }
+
+  uint32_t getHeight() const {
+    return height;
+  }
+
+  uint32_t at(uint32_t x, uint32_t y) const {
+    return data[xeFbConvert(tiledWidth, ((originY + y) * tiledWidth + originX + x) * 4)];
+  }
+
+  // Linear order over (a run of) pixels, stops after a fixed count. Iterators and ranges hold a copy of the
+  // view, so they stay valid when the view they came from (like a crop() temporary) is gone.
+  class PixelIterator;
+  class PixelRange;
+
+  // Every pixel, row by row
+  PixelRange pixels() const;
+
+  // A range per row, each a PixelRange
+  auto rows() const;
+
+  // A 32x32 tile as stored, tiled order and contiguous
+  struct Tile {
+    uint32_t x; // Tile coordinates, in tiles
+    uint32_t y;
+    std::span<const uint32_t, 1024> data;
+  };
+
+  // Every tile touching the view, in memory order
+  auto tiles() const {
+    const uint32_t firstX = originX >> 5;
+    const uint32_t firstY = originY >> 5;
+    const uint32_t countX = width ? ((originX + width + 31) >> 5) - firstX : 0;
+    const uint32_t countY = height ? ((originY + height + 31) >> 5) - firstY : 0;
+    return std::views::iota(0u, countX * countY) |
+           std::views::transform([*this, firstX, firstY, countX](uint32_t i) {
+             const uint32_t tx = firstX + i % countX;
+             const uint32_t ty = firstY + i / countX;
+             const uint32_t* tile = data + static_cast<uint64_t>(ty) * 32 * tiledWidth + tx * 1024;
+             return Tile{tx, ty, std::span<const uint32_t, 1024>(tile, 1024)};
+           });
+  }
+
+private:
+  const uint32_t* data;
+  uint32_t tiledWidth;
+  uint32_t originX;
+  uint32_t originY;
+  uint32_t width;
+  uint32_t height;
+};
+
+class TiledSurfaceView::PixelIterator {
+public:
+  using value_type = uint32_t;
+  using difference_type = std::ptrdiff_t;
+
+  PixelIterator() = default;
+  PixelIterator(const TiledSurfaceView& view, uint32_t y, uint64_t count)
+      : view(view), x(view.originX), y(view.originY + y), remaining(count) {
+    startRow();
+  }
+
+  uint32_t operator*() const {
+    return view.data[walker.address()];
+  }
+
+  PixelIterator& operator++() {
+    if (--remaining == 0)
+      return *this;
+    if (x + 1 == view.originX + view.width) {
+      x = view.originX;
+      y++;
+      startRow();
+      return *this;
+    }
+    walker.advance();
+    x++;
+    return *this;
+  }
+
+  PixelIterator operator++(int) {
+    PixelIterator it = *this;
+    ++*this;
+    return it;
+  }
+
+  // Column/row of the current pixel, relative to the view
+  uint32_t column() const {
+    return x - view.originX;
+  }
+
+  uint32_t row() const {
+    return y - view.originY;
+  }
+
+  bool operator==(const PixelIterator& other) const {
+    return remaining == other.remaining;
+  }
+
+  bool operator==(std::default_sentinel_t) const {
+    return remaining == 0;
+  }
+
+private:
+  void startRow() {
+    walker = FbScanlineWalker(view.tiledWidth, x, y);
+  }
+
+  TiledSurfaceView view = TiledSurfaceView(nullptr, 0, 0);
+  uint32_t x = 0;
+  uint32_t y = 0;
+  FbScanlineWalker walker;
+  uint64_t remaining = 0;
+};
+
+class TiledSurfaceView::PixelRange : public std::ranges::view_interface<PixelRange> {
+public:
+  PixelRange() = default;
+  PixelRange(const TiledSurfaceView& view, uint32_t y, uint64_t count) : view(view), y(y), count(count) {}
+
+  PixelIterator begin() const {
+    return count ? PixelIterator(view, y, count) : PixelIterator();
+  }
+
+  std::default_sentinel_t end() const {
+    return {};
+  }
+
+  uint64_t size() const {
+    return count;
+  }
+
+private:
+  TiledSurfaceView view = TiledSurfaceView(nullptr, 0, 0);
+  uint32_t y = 0;
+  uint64_t count = 0;
+};
+
+inline TiledSurfaceView::PixelRange TiledSurfaceView::pixels() const {
+  return PixelRange(*this, 0, static_cast<uint64_t>(width) * height);
+}
+
+inline auto TiledSurfaceView::rows() const {
+  return std::views::iota(0u, height) |
+         std::views::transform([*this](uint32_t y) { return PixelRange(*this, y, width); });
+}
+
+static_assert(std::forward_iterator<TiledSurfaceView::PixelIterator>);
+static_assert(std::ranges::view<TiledSurfaceView::PixelRange>);
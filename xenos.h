@@ -0,0 +1,118 @@
+// Copyright 2025 Xenon Emulator Project
+
+#pragma once
+
+#include <cstdint>
+
+#define TILE(x) ((((x) + 31) >> 5) << 5)
+
+// Surface formats we know how to convert, names follow the Xenos ones
+enum class SurfaceFormat : uint8_t {
+  k_8_8_8_8, // Resolved framebuffer (fbmem.bin)
+  k_DXT1,
+  k_DXT2_3,
+  k_DXT4_5,
+  k_DXN,
+  k_2_10_10_10_FLOAT,  // 7e3 render target, RGB 10 bit float + 2 bit alpha
+  k_16_16_16_16_FLOAT, // Half float RGBA render target
+};
+
+inline bool isBlockCompressed(SurfaceFormat format) {
+  switch (format) {
+  case SurfaceFormat::k_DXT1:
+  case SurfaceFormat::k_DXT2_3:
+  case SurfaceFormat::k_DXT4_5:
+  case SurfaceFormat::k_DXN:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Float render targets, these need tonemapping to be displayed
+inline bool isHDR(SurfaceFormat format) {
+  return format == SurfaceFormat::k_2_10_10_10_FLOAT || format == SurfaceFormat::k_16_16_16_16_FLOAT;
+}
+
+// Bytes per 4x4 block (or per pixel for uncompressed formats)
+inline uint32_t bytesPerBlock(SurfaceFormat format) {
+  switch (format) {
+  case SurfaceFormat::k_DXT1:
+  case SurfaceFormat::k_16_16_16_16_FLOAT:
+    return 8;
+  case SurfaceFormat::k_DXT2_3:
+  case SurfaceFormat::k_DXT4_5:
+  case SurfaceFormat::k_DXN:
+    return 16;
+  default:
+    return 4;
+  }
+}
+
+// Framebuffer tiling, CPU side of xeFbConvert in the compute shader.
+// This is xeTiledOffset2D below for 32bpp, wider surfaces have to use that one.
+// Takes the byte address of a linear pixel in a TILE(width) wide surface, returns the tiled pixel index.
+inline uint32_t xeFbConvert(uint32_t width, uint32_t addr) {
+  const uint32_t y = addr / (width * 4);
+  const uint32_t x = (addr % (width * 4)) / 4;
+  return ((((y & ~31u) * width) + (x & ~31u) * 32) +
+          (((x & 3) + ((y & 1) << 2) + ((x & 28) << 1) + ((y & 30) << 5)) ^ ((y & 8) << 2)));
+}
+
+// Walks the tiled addresses of one framebuffer scanline left to right, no division anywhere.
+// Each step carries from the 4 pixel groups (x & 3) into the next group (x & 28, swapped halves on
+// rows with y & 8) and then into the next tile, so it matches xeFbConvert for every pixel.
+class FbScanlineWalker {
+public:
+  FbScanlineWalker() = default;
+  FbScanlineWalker(uint32_t tiledWidth, uint32_t x, uint32_t y) : x(x), flip((y & 8) ? 4 : 0) {
+    addr = static_cast<int64_t>(y & ~31u) * tiledWidth + ((y & 1) << 2) + ((y & 30) << 5) + (x >> 5) * 1024 +
+           (((x >> 2) & 7) ^ flip) * 8 + (x & 3);
+  }
+
+  // Tiled pixel index of the current pixel
+  uint64_t address() const {
+    return static_cast<uint64_t>(addr);
+  }
+
+  void advance() {
+    const int32_t group = (x >> 2) & 7;
+    if ((x & 3) != 3)
+      addr += 1;
+    else if ((x & 31) != 31)
+      addr += (((group + 1) ^ flip) - (group ^ flip)) * 8 - 3;
+    else
+      addr += 1024 + ((0 ^ flip) - (7 ^ flip)) * 8 - 3;
+    x++;
+  }
+
+private:
+  uint32_t x = 0;
+  int32_t flip = 0;
+  int64_t addr = 0;
+};
+
+// Texture tiling, same as XGAddress2DTiledOffset. Coordinates and width are in blocks,
+// logBpb is log2(bytes per block) and the result is a block index.
+// At 4 bytes per block this is exactly xeFbConvert above. Other sizes (8 and 16 byte BCn blocks) keep the 32x32
+// block macro tiles but lay the blocks out differently inside them, so those need this one.
+inline uint32_t xeTiledOffset2D(uint32_t x, uint32_t y, uint32_t width, uint32_t logBpb) {
+  const uint32_t alignedWidth = TILE(width);
+  const uint32_t macro = ((x >> 5) + (y >> 5) * (alignedWidth >> 5)) << (logBpb + 7);
+  const uint32_t micro = ((x & 7) + ((y & 6) << 2)) << logBpb;
+  const uint32_t offset = macro + ((micro & ~15u) << 1) + (micro & 15) + ((y & 8) << (3 + logBpb)) + ((y & 1) << 4);
+  return ((((offset & ~511u) << 3) + ((offset & 448) << 2) + (offset & 63)) +
+          ((y & 16) << 7) + (((((y & 8) >> 2) + (x >> 3)) & 3) << 6)) >> logBpb;
+}
+
+// Size of the tiled source for a surface, padded out to whole 32x32 tiles (of blocks for BCn)
+inline uint64_t tiledSurfaceSize(SurfaceFormat format, uint32_t width, uint32_t height) {
+  if (!isBlockCompressed(format))
+    return static_cast<uint64_t>(TILE(width)) * TILE(height) * bytesPerBlock(format);
+  return static_cast<uint64_t>(TILE((width + 3) / 4)) * TILE((height + 3) / 4) * bytesPerBlock(format);
+}
+
+// Bytes per row of 32x32 tiles. Each row is contiguous in the tiled source, which is a whole number of them.
+inline uint64_t tiledRowSize(SurfaceFormat format, uint32_t width) {
+  return tiledSurfaceSize(format, width, isBlockCompressed(format) ? 32 * 4 : 32);
+}